@@ -0,0 +1,127 @@
+#include <cpuGovernor.hxx>
+
+//--------------------------------------------------------------------------------
+
+/**
+ * \brief CpuGovernor::instance
+ * Returns the governor shared by all widget instances of the process.
+ * \return Reference to the CpuGovernor singleton.
+ */
+CpuGovernor &CpuGovernor::instance()
+{
+    static CpuGovernor governor;
+    return governor;
+}
+
+CpuGovernor::CpuGovernor()
+{
+    connect(&m_timer, &QTimer::timeout, this, &CpuGovernor::evaluate);
+    m_timer.start(kIntervalMs);
+}
+
+void CpuGovernor::registerClient(QObject *client, int priority)
+{
+    Client state;
+    state.priority = priority;
+    m_clients.insert(client, state);
+}
+
+void CpuGovernor::unregisterClient(QObject *client)
+{
+    m_clients.remove(client);
+}
+
+void CpuGovernor::setPriority(QObject *client, int priority)
+{
+    auto it = m_clients.find(client);
+    if (it != m_clients.end())
+        it->priority = priority;
+}
+
+void CpuGovernor::addUsage(QObject *client, qint64 nsecs)
+{
+    auto it = m_clients.find(client);
+    if (it != m_clients.end())
+        it->usageNs += nsecs;
+}
+
+int CpuGovernor::level(QObject *client) const
+{
+    auto it = m_clients.constFind(client);
+    return it != m_clients.constEnd() ? it->level : Full;
+}
+
+double CpuGovernor::clientUsage(QObject *client) const
+{
+    auto it = m_clients.constFind(client);
+    return it != m_clients.constEnd() ? it->lastUsage : 0;
+}
+
+/**
+ * \brief CpuGovernor::setBudgetPercent
+ * Sets the budget for decode and paint of all widgets. Disabling the governor restores all widgets.
+ * \param percent Budget in percent of one CPU core, 0 to disable.
+ */
+void CpuGovernor::setBudgetPercent(int percent)
+{
+    m_budgetPercent = qMax(0, percent);
+    m_headroomIntervals = 0;
+    if (m_budgetPercent == 0) {
+        for (auto it = m_clients.begin(); it != m_clients.end(); ++it)
+            setLevel(it.key(), it.value(), Full);
+    }
+}
+
+void CpuGovernor::setLevel(QObject *client, Client &state, int level)
+{
+    if (state.level == level)
+        return;
+    state.level = level;
+    emit levelChanged(client, level);
+}
+
+/**
+ * \brief CpuGovernor::evaluate
+ * Closes the current measurement window and adjusts at most one client by one level,
+ * so the effect of each step is measured before the next one is taken.
+ */
+void CpuGovernor::evaluate()
+{
+    double windowSeconds = kIntervalMs / 1000.0;
+    m_totalUsage = 0;
+    for (Client &state : m_clients) {
+        state.lastUsage = state.usageNs / 1e6 / windowSeconds;
+        state.usageNs = 0;
+        m_totalUsage += state.lastUsage;
+    }
+    if (m_budgetPercent == 0 || m_clients.isEmpty())
+        return;
+
+    double budget = m_budgetPercent * 10.0; // ms per second
+    if (m_totalUsage > budget) {
+        m_headroomIntervals = 0;
+        // Degrade the lowest priority first; among equals the one using the most time
+        auto victim = m_clients.end();
+        for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+            if (it->level >= ReducedResolution)
+                continue;
+            if (victim == m_clients.end() || it->priority < victim->priority ||
+                (it->priority == victim->priority && it->lastUsage > victim->lastUsage))
+                victim = it;
+        }
+        if (victim != m_clients.end())
+            setLevel(victim.key(), victim.value(), victim->level + 1);
+    } else if (m_totalUsage < budget * kRestoreRatio && ++m_headroomIntervals >= kRestoreIntervals) {
+        m_headroomIntervals = 0;
+        // Restore the highest priority first
+        auto candidate = m_clients.end();
+        for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+            if (it->level == Full)
+                continue;
+            if (candidate == m_clients.end() || it->priority > candidate->priority)
+                candidate = it;
+        }
+        if (candidate != m_clients.end())
+            setLevel(candidate.key(), candidate.value(), candidate->level - 1);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef _cpuGovernor_H_
+#define _cpuGovernor_H_
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+
+//--------------------------------------------------------------------------------
+// Process-wide governor for the decode and paint time of all widget instances.
+// Widgets report the time they spend on the GUI thread; once per second the
+// governor compares the sum with the budget and degrades the lowest-priority
+// widget by one level when it is exceeded, or restores the highest-priority
+// degraded widget when there is headroom again. Usage is always measured, but
+// widgets are only degraded once a budget has been set.
+
+class CpuGovernor : public QObject
+{
+  Q_OBJECT
+
+  public:
+    // Degradation levels, each includes the ones before it
+    enum Level {
+        Full = 0,              // No degradation
+        FastScaling = 1,       // Nearest-neighbour instead of smooth scaling
+        SkipFrames = 2,        // Decode only every second frame; in tile mode every second delta
+        ReducedResolution = 3  // Ask the server for a reduced resolution
+    };
+
+    static CpuGovernor &instance();
+
+    void registerClient(QObject *client, int priority);
+    void unregisterClient(QObject *client);
+    void setPriority(QObject *client, int priority);
+    // Adds time spent by a client on decode or paint, in nanoseconds
+    void addUsage(QObject *client, qint64 nsecs);
+
+    int level(QObject *client) const;
+    // Client and process usage during the last evaluation window, in ms per second
+    double clientUsage(QObject *client) const;
+    double totalUsage() const { return m_totalUsage; }
+
+    // Budget as percent of one CPU core for all widgets together; 0 disables the governor
+    void setBudgetPercent(int percent);
+    int budgetPercent() const { return m_budgetPercent; }
+
+  signals:
+    void levelChanged(QObject *client, int level);
+
+  private slots:
+    void evaluate();
+
+  private:
+    CpuGovernor();
+
+    struct Client {
+        int priority = 0;
+        int level = Full;
+        qint64 usageNs = 0;      // Accumulated in the current window
+        double lastUsage = 0;    // ms per second in the last window
+    };
+
+    void setLevel(QObject *client, Client &state, int level);
+
+    static constexpr int kIntervalMs = 1000;
+    static constexpr double kRestoreRatio = 0.7;  // Usage below budget * ratio counts as headroom
+    static constexpr int kRestoreIntervals = 3;   // Windows with headroom before restoring a level
+
+    QHash<QObject *, Client> m_clients;
+    QTimer m_timer;
+    int m_budgetPercent = 0;      // Off until a panel opts in with setCpuBudget
+    int m_headroomIntervals = 0;
+    double m_totalUsage = 0;
+};
+
+#endif
@@ -0,0 +1,309 @@
+#include <frameCache.hxx>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QCoreApplication>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+//--------------------------------------------------------------------------------
+
+/**
+ * \brief FrameCache::instance
+ * Returns the process-wide cache shared by all widget instances.
+ * \return Reference to the FrameCache singleton.
+ */
+FrameCache &FrameCache::instance()
+{
+    static FrameCache cache;
+    return cache;
+}
+
+FrameCache::FrameCache()
+{
+    QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (base.isEmpty())
+        base = QDir::tempPath();
+    m_dir = base + "/streamingEWO/frames";
+    QDir().mkpath(m_dir);
+}
+
+FrameCache::~FrameCache()
+{
+    // Widgets flush their frames when they are destroyed; finish those writes first
+    m_pool.waitForDone();
+}
+
+/**
+ * \brief FrameCache::filePath
+ * Maps an RTSP URL to its file in the cache directory. The URL is hashed so that
+ * credentials in the URL never end up in a file name.
+ * \param url The RTSP stream URL.
+ * \return Absolute path of the cache file.
+ */
+QString FrameCache::filePath(const QString &url) const
+{
+    QByteArray hash = QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_dir + "/" + QString::fromLatin1(hash) + ".frame";
+}
+
+/**
+ * \brief FrameCache::lookup
+ * Returns the last cached frame for a stream if it is held in memory, i.e. it was seen or
+ * prewarmed in this process. Use fetch() to load it from disk.
+ * \param url The RTSP stream URL.
+ * \param serverTimestamp Optional output for the server timestamp of the cached frame.
+ * \return The compressed JPEG data, or an empty QByteArray if it is not in memory.
+ */
+QByteArray FrameCache::lookup(const QString &url, qint64 *serverTimestamp)
+{
+    if (url.isEmpty())
+        return QByteArray();
+    QMutexLocker lock(&m_mutex);
+    auto it = m_entries.find(url);
+    if (it == m_entries.end())
+        return QByteArray();
+    it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    if (serverTimestamp) *serverTimestamp = it->serverTimestamp;
+    return it->jpeg;
+}
+
+/**
+ * \brief FrameCache::fetch
+ * Loads a cached frame from disk on the cache's thread pool, so opening a panel never waits for
+ * the disk. The entry is kept in memory, and the result is delivered on the GUI thread.
+ * \param urls Cache keys in order of preference; the first one found is delivered.
+ * \param context The object the callback belongs to; the callback is dropped once it is destroyed.
+ * \param done Called with the JPEG and its server timestamp.
+ */
+void FrameCache::fetch(const QStringList &urls, QObject *context,
+                       std::function<void(const QByteArray &jpeg, qint64 serverTimestamp)> done)
+{
+    QPointer<QObject> guard(context);
+    m_pool.start([this, urls, guard, done]() {
+        for (const QString &url : urls) {
+            Entry entry;
+            if (url.isEmpty() || !readFile(url, entry))
+                continue;
+            {
+                QMutexLocker lock(&m_mutex);
+                auto it = m_entries.find(url);
+                if (it == m_entries.end())
+                    insertLocked(url, entry);
+                else
+                    entry = *it; // A live frame arrived meanwhile
+            }
+            QByteArray jpeg = entry.jpeg;
+            qint64 serverTimestamp = entry.serverTimestamp;
+            QCoreApplication *app = QCoreApplication::instance();
+            if (!app)
+                return; // Shutting down
+            QMetaObject::invokeMethod(app, [guard, done, jpeg, serverTimestamp]() {
+                if (guard)
+                    done(jpeg, serverTimestamp);
+            }, Qt::QueuedConnection);
+            return;
+        }
+    });
+}
+
+/**
+ * \brief FrameCache::store
+ * Remembers the newest good frame of a stream. The disk copy is refreshed asynchronously
+ * and at most every kMinWriteIntervalMs, so this is cheap enough to call for every frame.
+ * \param url The RTSP stream URL.
+ * \param jpeg The compressed JPEG data of the frame.
+ * \param serverTimestamp The server timestamp of the frame in ms since epoch.
+ */
+void FrameCache::store(const QString &url, const QByteArray &jpeg, qint64 serverTimestamp)
+{
+    if (url.isEmpty() || jpeg.isEmpty() || jpeg.size() > kMaxEntryBytes)
+        return;
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool write = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_entries.find(url);
+        if (it == m_entries.end()) {
+            insertLocked(url, Entry());
+            it = m_entries.find(url);
+        }
+        m_memoryBytes += jpeg.size() - it->jpeg.size();
+        it->jpeg = jpeg;
+        it->serverTimestamp = serverTimestamp;
+        it->lastUsed = now;
+        it->dirty = true;
+        if (now - it->lastWritten >= kMinWriteIntervalMs) {
+            it->lastWritten = now;
+            it->dirty = false;
+            write = true;
+        }
+        evictLocked(url);
+    }
+    if (write)
+        writeAsync(url, jpeg, serverTimestamp);
+}
+
+/**
+ * \brief FrameCache::flush
+ * Writes the newest frame of a stream to disk if it was held back by the write interval.
+ * Called when a widget goes away so the next panel open shows the most recent picture.
+ * \param url The RTSP stream URL.
+ */
+void FrameCache::flush(const QString &url)
+{
+    QByteArray jpeg;
+    qint64 serverTimestamp = 0;
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_entries.find(url);
+        if (it == m_entries.end() || !it->dirty)
+            return;
+        it->dirty = false;
+        it->lastWritten = QDateTime::currentMSecsSinceEpoch();
+        jpeg = it->jpeg;
+        serverTimestamp = it->serverTimestamp;
+    }
+    writeAsync(url, jpeg, serverTimestamp);
+}
+
+/**
+ * \brief FrameCache::prewarm
+ * Loads the disk entries of the given streams into memory on a worker thread, so that
+ * widgets opened afterwards find their first picture without touching the disk.
+ * \param urls List of RTSP stream URLs.
+ */
+void FrameCache::prewarm(const QStringList &urls)
+{
+    m_pool.start([this, urls]() {
+        for (const QString &url : urls) {
+            if (url.isEmpty())
+                continue;
+            {
+                QMutexLocker lock(&m_mutex);
+                if (m_entries.contains(url))
+                    continue;
+            }
+            Entry entry;
+            if (!readFile(url, entry))
+                continue;
+            QMutexLocker lock(&m_mutex);
+            if (!m_entries.contains(url))
+                insertLocked(url, entry);
+        }
+    });
+}
+
+/**
+ * \brief FrameCache::insertLocked
+ * Inserts an entry and evicts the least recently used ones beyond kMaxMemoryBytes.
+ * Must be called with m_mutex held.
+ * \param url The RTSP stream URL.
+ * \param entry The entry to insert.
+ */
+void FrameCache::insertLocked(const QString &url, const Entry &entry)
+{
+    auto it = m_entries.find(url);
+    if (it != m_entries.end())
+        m_memoryBytes -= it->jpeg.size();
+    m_entries.insert(url, entry);
+    m_memoryBytes += entry.jpeg.size();
+    evictLocked(url);
+}
+
+/**
+ * \brief FrameCache::evictLocked
+ * Drops the least recently used entries until the frames in memory fit into kMaxMemoryBytes.
+ * Evicted frames stay on disk. Must be called with m_mutex held.
+ * \param keep The entry just used, which is never evicted.
+ */
+void FrameCache::evictLocked(const QString &keep)
+{
+    while (m_memoryBytes > kMaxMemoryBytes) {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it.key() != keep && (oldest == m_entries.end() || it->lastUsed < oldest->lastUsed))
+                oldest = it;
+        }
+        if (oldest == m_entries.end())
+            break;
+        m_memoryBytes -= oldest->jpeg.size();
+        m_entries.erase(oldest);
+    }
+}
+
+/**
+ * \brief FrameCache::readFile
+ * Reads a cache file. The file holds the 8 byte server timestamp followed by the JPEG,
+ * the same layout StreamServer uses on the wire.
+ * \param url The RTSP stream URL.
+ * \param entry Receives the frame data and timestamp.
+ * \return True if a valid entry was read.
+ */
+bool FrameCache::readFile(const QString &url, Entry &entry) const
+{
+    QFile file(filePath(url));
+    if (file.size() <= 8 || file.size() > kMaxEntryBytes + 8 || !file.open(QIODevice::ReadOnly))
+        return false;
+    QByteArray data = file.readAll();
+    if (data.size() <= 8)
+        return false;
+    QDataStream tsStream(data.left(8));
+    tsStream >> entry.serverTimestamp;
+    entry.jpeg = data.mid(8);
+    entry.lastUsed = QDateTime::currentMSecsSinceEpoch();
+    entry.lastWritten = entry.lastUsed; // Already on disk
+    return true;
+}
+
+/**
+ * \brief FrameCache::writeAsync
+ * Writes a cache file atomically on the cache's thread pool and trims the cache directory.
+ * \param url The RTSP stream URL.
+ * \param jpeg The compressed JPEG data.
+ * \param serverTimestamp The server timestamp of the frame.
+ */
+void FrameCache::writeAsync(const QString &url, const QByteArray &jpeg, qint64 serverTimestamp)
+{
+    QString path = filePath(url);
+    m_pool.start([this, path, jpeg, serverTimestamp]() {
+        QMutexLocker lock(&m_diskMutex);
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+        QByteArray timestampData;
+        QDataStream tsStream(&timestampData, QIODevice::WriteOnly);
+        tsStream << serverTimestamp;
+        file.write(timestampData);
+        file.write(jpeg);
+        if (file.commit())
+            enforceDiskLimit();
+    });
+}
+
+/**
+ * \brief FrameCache::enforceDiskLimit
+ * Deletes the oldest cache files until the directory is below kMaxDiskBytes.
+ * Must be called with m_diskMutex held.
+ */
+void FrameCache::enforceDiskLimit()
+{
+    QDir dir(m_dir);
+    // Newest first, so the files at the end of the list are evicted
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.frame", QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &info : files)
+        total += info.size();
+    while (total > kMaxDiskBytes && !files.isEmpty()) {
+        QFileInfo oldest = files.takeLast();
+        if (QFile::remove(oldest.absoluteFilePath()))
+            total -= oldest.size();
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef _frameCache_H_
+#define _frameCache_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+
+//--------------------------------------------------------------------------------
+// Process-wide cache of the last good compressed frame per RTSP URL.
+// Entries live in memory and are mirrored to disk so a newly opened panel can
+// show a (stale) picture before the live stream delivers its first frame.
+// All disk access runs on a private thread pool, which is drained before the
+// cache is destroyed, so tasks queued at shutdown never outlive it.
+
+class FrameCache
+{
+  public:
+    static FrameCache &instance();
+
+    // Returns the cached JPEG for url if it is in memory, or an empty array; never touches the disk
+    QByteArray lookup(const QString &url, qint64 *serverTimestamp = nullptr);
+    // Reads the first of urls found on disk in the background and calls done with it on the GUI
+    // thread, unless context has been destroyed by then. Not called if none is cached.
+    void fetch(const QStringList &urls, QObject *context, std::function<void(const QByteArray &jpeg, qint64 serverTimestamp)> done);
+    // Remembers the frame and writes it to disk at most every kMinWriteIntervalMs per URL
+    void store(const QString &url, const QByteArray &jpeg, qint64 serverTimestamp);
+    // Writes the newest in-memory frame for url if it has not been written yet
+    void flush(const QString &url);
+    // Loads the disk entries for urls into memory in the background
+    void prewarm(const QStringList &urls);
+
+  private:
+    FrameCache();
+    ~FrameCache();
+    FrameCache(const FrameCache &) = delete;
+    FrameCache &operator=(const FrameCache &) = delete;
+
+    struct Entry {
+        QByteArray jpeg;
+        qint64 serverTimestamp = 0;
+        qint64 lastUsed = 0;       // For evicting memory entries
+        qint64 lastWritten = 0;    // Client time of the last disk write, 0 if never
+        bool dirty = false;        // Newer than what is on disk
+    };
+
+    QString filePath(const QString &url) const;
+    void insertLocked(const QString &url, const Entry &entry);
+    void evictLocked(const QString &keep);
+    void writeAsync(const QString &url, const QByteArray &jpeg, qint64 serverTimestamp);
+    bool readFile(const QString &url, Entry &entry) const;
+    void enforceDiskLimit();
+
+    static constexpr int kMaxEntryBytes = 4 * 1024 * 1024;        // Larger frames are not cached
+    static constexpr qint64 kMaxDiskBytes = 64ll * 1024 * 1024;   // Total size of the cache directory
+    static constexpr qint64 kMaxMemoryBytes = 16ll * 1024 * 1024; // Total size of the frames held in memory
+    static constexpr qint64 kMinWriteIntervalMs = 5000;
+
+    QString m_dir;
+    QMutex m_mutex;      // Guards m_entries
+    QMutex m_diskMutex;  // Serializes writes and eviction in the cache directory
+    QHash<QString, Entry> m_entries;
+    qint64 m_memoryBytes = 0;  // Sum of the JPEG sizes in m_entries
+    QThreadPool m_pool;        // Declared last, so it is drained before the other members go away
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include <incrementalDecoder.hxx>
+
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QThreadPool>
+
+//--------------------------------------------------------------------------------
+
+namespace {
+// Workers block while they wait for fragments, so they get their own pool instead of
+// holding threads of the global pool that the frame cache and snapshots use
+QThreadPool &decodePool()
+{
+    static QThreadPool pool;
+    return pool;
+}
+}
+
+struct IncrementalJpegDecoder::State
+{
+    QMutex mutex;
+    QWaitCondition changed;      // Data appended, message complete, decode abandoned or done
+    QByteArray buffer;           // Appended on the GUI thread only, read by the worker under mutex
+    qsizetype offset = 0;        // Start of the JPEG in buffer
+    quint64 generation = 0;      // Changes when a decode is abandoned or taken over by finish()
+    bool complete = false;
+    bool started = false;        // A worker runs the decode of the current generation
+    bool done = false;
+    bool ok = false;
+    QImage image;
+    qint64 decodeNsecs = 0;
+};
+
+// Sequential device over the message buffer. Reads block until the next fragment
+// arrives, so the JPEG reader sees one continuous stream.
+class IncrementalJpegDecoder::FeedDevice : public QIODevice
+{
+  public:
+    FeedDevice(State &state, quint64 generation, qsizetype pos)
+      : m_state(state), m_generation(generation), m_pos(pos) {}
+
+    bool isSequential() const override { return true; }
+    bool atEnd() const override
+    {
+        QMutexLocker lock(&m_state.mutex);
+        return !waitForData();
+    }
+    qint64 waitNsecs() const { return m_waitNsecs; }
+
+  protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        QMutexLocker lock(&m_state.mutex);
+        if (!waitForData())
+            return -1;
+        qint64 size = qMin<qint64>(maxSize, m_state.buffer.size() - m_pos);
+        memcpy(data, m_state.buffer.constData() + m_pos, size_t(size));
+        m_pos += size;
+        return size;
+    }
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+  private:
+    // Must be called with the mutex held. False at the end of the message or if the decode was abandoned.
+    bool waitForData() const
+    {
+        if (m_state.generation == m_generation && m_pos >= m_state.buffer.size() && !m_state.complete) {
+            QElapsedTimer timer;
+            timer.start();
+            while (m_state.generation == m_generation && m_pos >= m_state.buffer.size() && !m_state.complete)
+                m_state.changed.wait(&m_state.mutex);
+            m_waitNsecs += timer.nsecsElapsed();
+        }
+        return m_state.generation == m_generation && m_pos < m_state.buffer.size();
+    }
+
+    State &m_state;
+    quint64 m_generation;
+    qsizetype m_pos;
+    mutable qint64 m_waitNsecs = 0;
+};
+
+//--------------------------------------------------------------------------------
+
+IncrementalJpegDecoder::IncrementalJpegDecoder()
+  : m_state(new State)
+{
+}
+
+IncrementalJpegDecoder::~IncrementalJpegDecoder()
+{
+    abort(); // A running worker stops at its next read and then only holds its own reference
+}
+
+/**
+ * \brief IncrementalJpegDecoder::reset
+ * Prepares for a new message. The buffer keeps its capacity, so steady streams do not allocate.
+ */
+void IncrementalJpegDecoder::reset()
+{
+    abort();
+    QMutexLocker lock(&m_state->mutex);
+    m_state->buffer.resize(0);
+    m_state->offset = 0;
+    m_state->complete = false;
+    m_state->started = false;
+    m_state->done = false;
+    m_state->ok = false;
+    m_state->image = QImage();
+}
+
+/**
+ * \brief IncrementalJpegDecoder::append
+ * Adds a received fragment to the message and wakes a worker waiting for it.
+ * \param fragment Payload of a WebSocket frame.
+ */
+void IncrementalJpegDecoder::append(const QByteArray &fragment)
+{
+    QMutexLocker lock(&m_state->mutex);
+    m_state->buffer.append(fragment);
+    if (m_decoding)
+        m_state->changed.wakeAll();
+}
+
+/**
+ * \brief IncrementalJpegDecoder::startDecode
+ * Queues the decode of the message's JPEG on the decoder thread pool.
+ * \param offset Position of the JPEG in the message, i.e. the size of the frame header.
+ */
+void IncrementalJpegDecoder::startDecode(qsizetype offset)
+{
+    if (m_decoding)
+        return;
+    quint64 generation;
+    {
+        QMutexLocker lock(&m_state->mutex);
+        m_state->offset = offset;
+        m_state->started = false;
+        m_state->done = false;
+        generation = m_state->generation;
+    }
+    m_decoding = true;
+    QSharedPointer<State> state = m_state;
+    decodePool().start([state, generation]() { decode(state, generation); });
+}
+
+/**
+ * \brief IncrementalJpegDecoder::finish
+ * Marks the message as complete and returns the decoded frame.
+ * \param image Receives the frame.
+ * \return False if no decode was started or the JPEG could not be decoded.
+ */
+bool IncrementalJpegDecoder::finish(QImage &image)
+{
+    if (!m_decoding)
+        return false;
+    m_decoding = false;
+    QMutexLocker lock(&m_state->mutex);
+    m_state->complete = true;
+    if (!m_state->started) {
+        // All workers are busy; waiting for this one would only add its queueing delay
+        m_state->generation++;
+        lock.unlock();
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = image.loadFromData(QByteArrayView(m_state->buffer).sliced(m_state->offset), "JPEG");
+        m_lastDecodeNsecs = timer.nsecsElapsed();
+        return ok;
+    }
+    m_state->changed.wakeAll();
+    while (!m_state->done)
+        m_state->changed.wait(&m_state->mutex);
+    image = m_state->image;
+    m_lastDecodeNsecs = m_state->decodeNsecs;
+    return m_state->ok;
+}
+
+/**
+ * \brief IncrementalJpegDecoder::abort
+ * Abandons the running decode without waiting for it. The worker's next read fails, and its
+ * result is discarded.
+ */
+void IncrementalJpegDecoder::abort()
+{
+    if (!m_decoding)
+        return;
+    m_decoding = false;
+    QMutexLocker lock(&m_state->mutex);
+    m_state->generation++;
+    m_state->changed.wakeAll();
+}
+
+/**
+ * \brief IncrementalJpegDecoder::decode
+ * Worker: decodes the JPEG with Qt's reader while the fragments arrive.
+ * \param state The decoder's shared state.
+ * \param generation The decode this worker was started for.
+ */
+void IncrementalJpegDecoder::decode(QSharedPointer<State> state, quint64 generation)
+{
+    qsizetype offset = 0;
+    {
+        QMutexLocker lock(&state->mutex);
+        if (state->generation != generation)
+            return; // Abandoned, or finish() decoded it itself
+        state->started = true;
+        offset = state->offset;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    FeedDevice device(*state, generation, offset);
+    device.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    QImageReader reader(&device, "jpeg");
+    QImage image;
+    bool ok = reader.read(&image);
+
+    QMutexLocker lock(&state->mutex);
+    if (state->generation != generation)
+        return;
+    state->image = image;
+    state->ok = ok;
+    state->decodeNsecs = timer.nsecsElapsed() - device.waitNsecs();
+    state->done = true;
+    state->changed.wakeAll();
+}
@@ -0,0 +1,51 @@
+#ifndef _incrementalDecoder_H_
+#define _incrementalDecoder_H_
+
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+//--------------------------------------------------------------------------------
+// Decodes a JPEG while its WebSocket message is still arriving.
+// StreamServer sends large frames as several WebSocket fragments. They are
+// collected in one buffer that keeps its capacity from message to message.
+// After the first fragment, Qt's JPEG reader starts on a worker thread. It
+// reads from a device that blocks until the next fragment arrives, so decoding
+// overlaps with the transfer and only the tail is left after the last fragment.
+
+class IncrementalJpegDecoder
+{
+  public:
+    IncrementalJpegDecoder();
+    ~IncrementalJpegDecoder();
+
+    // Starts a new message; a decode still running for the previous one is abandoned
+    void reset();
+    void append(const QByteArray &fragment);
+    // Starts decoding the JPEG that begins at offset in the message
+    void startDecode(qsizetype offset);
+    bool isDecoding() const { return m_decoding; }
+    // Marks the message as complete and waits for the decode. If no worker has
+    // picked it up yet, the JPEG is decoded on the calling thread instead.
+    bool finish(QImage &image);
+    // Abandons the decode, e.g. for a frame that is not going to be shown
+    void abort();
+
+    // The message received so far; complete after the last fragment
+    const QByteArray &message() const { return m_state->buffer; }
+    // Decode time of the last finished frame, without the time spent waiting for data
+    qint64 lastDecodeNsecs() const { return m_lastDecodeNsecs; }
+
+  private:
+    struct State;
+    class FeedDevice;
+    static void decode(QSharedPointer<State> state, quint64 generation);
+
+    QSharedPointer<State> m_state;  // Shared with the worker, which may outlive an abandoned decode
+    bool m_decoding = false;
+    qint64 m_lastDecodeNsecs = 0;
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include <lensUndistort.hxx>
+
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LENSREMAP_SSE2
+#endif
+
+//--------------------------------------------------------------------------------
+
+namespace {
+/**
+ * \brief sampleBilinear
+ * Interpolates the 2x2 source pixels at a fixed-point position (8 fraction bits).
+ * The position must leave room for the right and bottom neighbour.
+ */
+inline quint32 sampleBilinear(const uchar *bits, qsizetype bytesPerLine, qint32 fixedX, qint32 fixedY)
+{
+    const int x = fixedX >> 8;
+    const int y = fixedY >> 8;
+    const quint32 wx = quint32(fixedX & 0xff);
+    const quint32 wy = quint32(fixedY & 0xff);
+    const quint32 *row0 = reinterpret_cast<const quint32 *>(bits + y * bytesPerLine) + x;
+    const quint32 *row1 = reinterpret_cast<const quint32 *>(bits + (y + 1) * bytesPerLine) + x;
+#ifdef LENSREMAP_SSE2
+    // Both horizontal neighbours of a row are loaded at once and widened to 16 bit per channel
+    const __m128i zero = _mm_setzero_si128();
+    __m128i top = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row0)), zero);
+    __m128i bottom = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row1)), zero);
+    // At most 255 * 256, so the unsigned 16 bit lanes cannot overflow
+    __m128i vertical = _mm_add_epi16(_mm_mullo_epi16(top, _mm_set1_epi16(short(256 - wy))),
+                                     _mm_mullo_epi16(bottom, _mm_set1_epi16(short(wy))));
+    vertical = _mm_srli_epi16(vertical, 8);
+    // Lanes 0..3 hold the left pixel, lanes 4..7 the right one
+    const __m128i weights = _mm_set_epi16(short(wx), short(wx), short(wx), short(wx),
+                                          short(256 - wx), short(256 - wx), short(256 - wx), short(256 - wx));
+    __m128i horizontal = _mm_mullo_epi16(vertical, weights);
+    horizontal = _mm_add_epi16(horizontal, _mm_srli_si128(horizontal, 8));
+    horizontal = _mm_srli_epi16(horizontal, 8);
+    return quint32(_mm_cvtsi128_si32(_mm_packus_epi16(horizontal, zero)));
+#else
+    // Same arithmetic as the SSE2 path, one channel at a time
+    quint32 result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        quint32 left = ((((row0[0] >> shift) & 0xff) * (256 - wy) + ((row1[0] >> shift) & 0xff) * wy) >> 8) & 0xffff;
+        quint32 right = ((((row0[1] >> shift) & 0xff) * (256 - wy) + ((row1[1] >> shift) & 0xff) * wy) >> 8) & 0xffff;
+        quint32 value = ((left * (256 - wx) + right * wx) & 0xffff) >> 8;
+        result |= value << shift;
+    }
+    return result;
+#endif
+}
+}
+
+bool LensRemap::Calibration::operator==(const Calibration &other) const
+{
+    return imageSize == other.imageSize && fx == other.fx && fy == other.fy && cx == other.cx &&
+           cy == other.cy && k1 == other.k1 && k2 == other.k2 && p1 == other.p1 && p2 == other.p2 &&
+           k3 == other.k3;
+}
+
+/**
+ * \brief LensRemap::setCalibration
+ * Sets the camera calibration; the remap table is rebuilt on the next remap() if it changed.
+ * \param calibration Intrinsics and distortion coefficients as sent by the server.
+ */
+void LensRemap::setCalibration(const Calibration &calibration)
+{
+    if (m_calibration == calibration)
+        return;
+    m_calibration = calibration;
+    m_table.clear();
+    m_tableAlpha = -1;
+}
+
+/**
+ * \brief LensRemap::clear
+ * Forgets the calibration and releases the remap table.
+ */
+void LensRemap::clear()
+{
+    setCalibration(Calibration());
+}
+
+/**
+ * \brief LensRemap::remap
+ * Renders a region of the undistorted camera frame. Rebuilds the remap table only when the
+ * source size, a region, the output size or alpha changed.
+ * \param source Received frame, showing sourceRoi of the distorted camera frame.
+ * \param sourceRoi Normalized region of the camera frame that source shows.
+ * \param output Target image in Format_RGB32; its size is the output size.
+ * \param outputRoi Normalized region of the undistorted frame to render.
+ * \param alpha Free scaling parameter, 0 = valid pixels only, 1 = all source pixels.
+ * \param fast Nearest-neighbour instead of bilinear lookups, e.g. when over the CPU budget.
+ */
+void LensRemap::remap(const QImage &source, const QRectF &sourceRoi, QImage &output, const QRectF &outputRoi,
+                      double alpha, bool fast)
+{
+    if (output.isNull())
+        return;
+    if (!hasCalibration() || source.width() < 2 || source.height() < 2 || sourceRoi.isEmpty() || outputRoi.isEmpty()) {
+        output.fill(Qt::black);
+        return;
+    }
+    const QImage src = source.format() == QImage::Format_RGB32 ? source : source.convertToFormat(QImage::Format_RGB32);
+    if (m_table.isEmpty() || m_tableSourceSize != src.size() || m_tableSourceRoi != sourceRoi ||
+        m_tableOutputSize != output.size() || m_tableOutputRoi != outputRoi || m_tableAlpha != alpha)
+        buildTable(src.size(), sourceRoi, output.size(), outputRoi, alpha);
+
+    const uchar *bits = src.constBits();
+    const qsizetype bytesPerLine = src.bytesPerLine();
+    const qint32 *entry = m_table.constData();
+    for (int y = 0; y < output.height(); ++y) {
+        quint32 *line = reinterpret_cast<quint32 *>(output.scanLine(y));
+        for (int x = 0; x < output.width(); ++x, entry += 2) {
+            if (entry[0] == kInvalid) {
+                line[x] = 0xff000000;
+            } else if (fast) {
+                const int sx = (entry[0] + 128) >> kFractionBits;
+                const int sy = (entry[1] + 128) >> kFractionBits;
+                line[x] = reinterpret_cast<const quint32 *>(bits + sy * bytesPerLine)[sx];
+            } else {
+                line[x] = sampleBilinear(bits, bytesPerLine, entry[0], entry[1]);
+            }
+        }
+    }
+}
+
+/**
+ * \brief LensRemap::buildTable
+ * Computes the source position of every output pixel: output pixel -> undistorted camera pixel
+ * (new camera matrix for alpha) -> distorted camera pixel (lens model) -> pixel of the source image.
+ */
+void LensRemap::buildTable(const QSize &sourceSize, const QRectF &sourceRoi, const QSize &outputSize,
+                           const QRectF &outputRoi, double alpha)
+{
+    const double w = m_calibration.imageSize.width();
+    const double h = m_calibration.imageSize.height();
+
+    // New camera matrix as OpenCV's getOptimalNewCameraMatrix: interpolate between the largest
+    // rectangle inside the undistorted border (alpha 0) and the one around it (alpha 1)
+    const int gridSize = 9;
+    const double inf = std::numeric_limits<double>::max();
+    double innerX0 = -inf, innerX1 = inf, innerY0 = -inf, innerY1 = inf;
+    double outerX0 = inf, outerX1 = -inf, outerY0 = inf, outerY1 = -inf;
+    for (int j = 0; j < gridSize; ++j) {
+        for (int i = 0; i < gridSize; ++i) {
+            double x, y;
+            undistort(i * (w - 1) / (gridSize - 1), j * (h - 1) / (gridSize - 1), x, y);
+            outerX0 = qMin(outerX0, x);
+            outerX1 = qMax(outerX1, x);
+            outerY0 = qMin(outerY0, y);
+            outerY1 = qMax(outerY1, y);
+            if (i == 0) innerX0 = qMax(innerX0, x);
+            if (i == gridSize - 1) innerX1 = qMin(innerX1, x);
+            if (j == 0) innerY0 = qMax(innerY0, y);
+            if (j == gridSize - 1) innerY1 = qMin(innerY1, y);
+        }
+    }
+    if (innerX1 <= innerX0 || innerY1 <= innerY0) {
+        // Extreme distortion: the inner rectangle is empty, use the outer one
+        innerX0 = outerX0; innerX1 = outerX1; innerY0 = outerY0; innerY1 = outerY1;
+    }
+    alpha = qBound(0.0, alpha, 1.0);
+    const double fxInner = (w - 1) / (innerX1 - innerX0), fyInner = (h - 1) / (innerY1 - innerY0);
+    const double fxOuter = (w - 1) / (outerX1 - outerX0), fyOuter = (h - 1) / (outerY1 - outerY0);
+    const double newFx = fxInner * (1 - alpha) + fxOuter * alpha;
+    const double newFy = fyInner * (1 - alpha) + fyOuter * alpha;
+    const double newCx = -fxInner * innerX0 * (1 - alpha) - fxOuter * outerX0 * alpha;
+    const double newCy = -fyInner * innerY0 * (1 - alpha) - fyOuter * outerY0 * alpha;
+
+    // Valid fixed-point source positions leave room for the bilinear neighbours
+    const qint32 maxX = qint32((sourceSize.width() - 1) << kFractionBits) - 1;
+    const qint32 maxY = qint32((sourceSize.height() - 1) << kFractionBits) - 1;
+    const double scaleX = sourceSize.width() / sourceRoi.width();
+    const double scaleY = sourceSize.height() / sourceRoi.height();
+
+    m_table.resize(qsizetype(outputSize.width()) * outputSize.height() * 2);
+    qint32 *entry = m_table.data();
+    for (int v = 0; v < outputSize.height(); ++v) {
+        const double undistortedY = (outputRoi.y() + (v + 0.5) / outputSize.height() * outputRoi.height()) * h - 0.5;
+        const double y = (undistortedY - newCy) / newFy;
+        for (int u = 0; u < outputSize.width(); ++u, entry += 2) {
+            const double undistortedX = (outputRoi.x() + (u + 0.5) / outputSize.width() * outputRoi.width()) * w - 0.5;
+            const double x = (undistortedX - newCx) / newFx;
+            double xd, yd;
+            distort(x, y, xd, yd);
+            // Distorted camera pixel, normalized, then mapped into the received region
+            const double nx = (m_calibration.fx * xd + m_calibration.cx + 0.5) / w;
+            const double ny = (m_calibration.fy * yd + m_calibration.cy + 0.5) / h;
+            const double sx = (nx - sourceRoi.x()) * scaleX - 0.5;
+            const double sy = (ny - sourceRoi.y()) * scaleY - 0.5;
+            if (sx < -0.5 || sy < -0.5 || sx > sourceSize.width() - 0.5 || sy > sourceSize.height() - 0.5) {
+                entry[0] = kInvalid;
+                entry[1] = kInvalid;
+                continue;
+            }
+            entry[0] = qBound<qint32>(0, qint32(std::lround(sx * (1 << kFractionBits))), maxX);
+            entry[1] = qBound<qint32>(0, qint32(std::lround(sy * (1 << kFractionBits))), maxY);
+        }
+    }
+    m_tableSourceSize = sourceSize;
+    m_tableSourceRoi = sourceRoi;
+    m_tableOutputSize = outputSize;
+    m_tableOutputRoi = outputRoi;
+    m_tableAlpha = alpha;
+}
+
+/**
+ * \brief LensRemap::distort
+ * Applies the lens model to a normalized undistorted point.
+ */
+void LensRemap::distort(double x, double y, double &xd, double &yd) const
+{
+    const Calibration &c = m_calibration;
+    const double r2 = x * x + y * y;
+    const double radial = 1 + ((c.k3 * r2 + c.k2) * r2 + c.k1) * r2;
+    xd = x * radial + 2 * c.p1 * x * y + c.p2 * (r2 + 2 * x * x);
+    yd = y * radial + c.p1 * (r2 + 2 * y * y) + 2 * c.p2 * x * y;
+}
+
+/**
+ * \brief LensRemap::undistort
+ * Inverts the lens model for a distorted pixel by fixed-point iteration, as OpenCV's undistortPoints.
+ * \param u Distorted pixel x of the calibration resolution.
+ * \param v Distorted pixel y of the calibration resolution.
+ * \param x Receives the normalized undistorted x.
+ * \param y Receives the normalized undistorted y.
+ */
+void LensRemap::undistort(double u, double v, double &x, double &y) const
+{
+    const Calibration &c = m_calibration;
+    const double x0 = (u - c.cx) / c.fx;
+    const double y0 = (v - c.cy) / c.fy;
+    x = x0;
+    y = y0;
+    for (int i = 0; i < 20; ++i) {
+        const double r2 = x * x + y * y;
+        const double inverseRadial = 1 / (1 + ((c.k3 * r2 + c.k2) * r2 + c.k1) * r2);
+        const double dx = 2 * c.p1 * x * y + c.p2 * (r2 + 2 * x * x);
+        const double dy = c.p1 * (r2 + 2 * y * y) + 2 * c.p2 * x * y;
+        x = (x0 - dx) * inverseRadial;
+        y = (y0 - dy) * inverseRadial;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef _lensUndistort_H_
+#define _lensUndistort_H_
+
+#include <QImage>
+#include <QList>
+#include <QRectF>
+#include <QSize>
+
+//--------------------------------------------------------------------------------
+// Client-side lens undistortion.
+// StreamServer sends the camera intrinsics and distortion coefficients once
+// (camera_calibration). From them a fixed-point remap table is built for the
+// current output size, alpha and region; it only changes when one of those
+// changes. Applying the table is a bilinear lookup per output pixel (SSE2 where
+// available), done while the frame is scaled for display.
+// The distortion model is the one of OpenCV: radial k1, k2, k3 and tangential p1, p2.
+
+class LensRemap
+{
+  public:
+    struct Calibration {
+        QSize imageSize;                 // Resolution the intrinsics refer to
+        double fx = 0, fy = 0, cx = 0, cy = 0;
+        double k1 = 0, k2 = 0, p1 = 0, p2 = 0, k3 = 0;
+
+        bool isValid() const { return imageSize.width() > 1 && imageSize.height() > 1 && fx > 0 && fy > 0; }
+        bool operator==(const Calibration &other) const;
+    };
+
+    void setCalibration(const Calibration &calibration);
+    const Calibration &calibration() const { return m_calibration; }
+    bool hasCalibration() const { return m_calibration.isValid(); }
+    void clear();
+
+    // Renders outputRoi of the undistorted camera frame into output (Format_RGB32, size kept).
+    // source shows sourceRoi of the distorted camera frame; both regions are normalized to 0..1.
+    // alpha 0 keeps only valid pixels, 1 keeps all source pixels (OpenCV getOptimalNewCameraMatrix).
+    // fast uses nearest-neighbour lookups instead of bilinear filtering.
+    void remap(const QImage &source, const QRectF &sourceRoi, QImage &output, const QRectF &outputRoi,
+               double alpha, bool fast);
+
+  private:
+    void buildTable(const QSize &sourceSize, const QRectF &sourceRoi, const QSize &outputSize,
+                    const QRectF &outputRoi, double alpha);
+    void distort(double x, double y, double &xd, double &yd) const;
+    void undistort(double u, double v, double &x, double &y) const;
+
+    static constexpr int kFractionBits = 8;           // Table entries are source pixels * 256
+    static constexpr qint32 kInvalid = -0x7fffffff;   // Output pixel has no source pixel, drawn black
+
+    Calibration m_calibration;
+    // Table as interleaved x, y per output pixel, and the parameters it was built for
+    QList<qint32> m_table;
+    QSize m_tableSourceSize;
+    QRectF m_tableSourceRoi;
+    QSize m_tableOutputSize;
+    QRectF m_tableOutputRoi;
+    double m_tableAlpha = -1;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include <mosaicView.hxx>
+
+#include <cmath>
+
+//--------------------------------------------------------------------------------
+
+/**
+ * \brief MosaicView::setStreams
+ * Sets the streams of the mosaic, one tile per URL in grid order.
+ * \param urls List of RTSP stream URLs; entries beyond kMaxTiles are ignored.
+ */
+void MosaicView::setStreams(const QStringList &urls)
+{
+    QList<MosaicTile> tiles;
+    for (int i = 0; i < urls.size() && i < kMaxTiles; ++i) {
+        MosaicTile tile;
+        for (const MosaicTile &existing : m_tiles) {
+            if (existing.url == urls.at(i)) {
+                tile = existing;
+                break;
+            }
+        }
+        tile.url = urls.at(i);
+        tile.name = m_names.value(i);
+        tiles.append(tile);
+    }
+    m_tiles = tiles;
+}
+
+/**
+ * \brief MosaicView::setNames
+ * Sets the names shown in the tiles, in the same order as the streams.
+ * \param names List of names; missing entries show no name box.
+ */
+void MosaicView::setNames(const QStringList &names)
+{
+    m_names = names;
+    for (int i = 0; i < m_tiles.size(); ++i)
+        m_tiles[i].name = m_names.value(i);
+}
+
+void MosaicView::setColumns(int columns)
+{
+    m_columns = qMax(0, columns);
+}
+
+int MosaicView::columns() const
+{
+    if (m_tiles.isEmpty())
+        return 0;
+    if (m_columns > 0)
+        return qMin(m_columns, int(m_tiles.size()));
+    return int(std::ceil(std::sqrt(double(m_tiles.size()))));
+}
+
+int MosaicView::rows() const
+{
+    int cols = columns();
+    return cols > 0 ? (int(m_tiles.size()) + cols - 1) / cols : 0;
+}
+
+/**
+ * \brief MosaicView::cellRect
+ * Returns the cell of a tile. Cell edges are rounded so that the grid fills the area exactly,
+ * with kSpacing between neighbouring cells.
+ * \param index Tile index.
+ * \param area The widget area the grid is laid out in.
+ * \return The cell in widget coordinates.
+ */
+QRect MosaicView::cellRect(int index, const QRect &area) const
+{
+    int cols = columns();
+    int rowCount = rows();
+    if (index < 0 || index >= m_tiles.size() || cols == 0)
+        return QRect();
+    int col = index % cols;
+    int row = index / cols;
+    int left = area.left() + area.width() * col / cols;
+    int right = area.left() + area.width() * (col + 1) / cols - (col < cols - 1 ? kSpacing : 0);
+    int top = area.top() + area.height() * row / rowCount;
+    int bottom = area.top() + area.height() * (row + 1) / rowCount - (row < rowCount - 1 ? kSpacing : 0);
+    return QRect(QPoint(left, top), QPoint(right - 1, bottom - 1));
+}
+
+QRect MosaicView::imageRect(int index, const QRect &area) const
+{
+    QRect cell = cellRect(index, area);
+    const QImage &image = m_tiles.at(index).image;
+    if (image.isNull() || cell.isEmpty())
+        return cell;
+    QRect target(QPoint(0, 0), image.size().scaled(cell.size(), Qt::KeepAspectRatio));
+    target.moveCenter(cell.center());
+    return target;
+}
+
+/**
+ * \brief MosaicView::tileAt
+ * Finds the tile under a widget position.
+ * \param pos Position in widget coordinates.
+ * \param area The widget area the grid is laid out in.
+ * \return The tile index, or -1 for a gap or an empty cell.
+ */
+int MosaicView::tileAt(const QPoint &pos, const QRect &area) const
+{
+    for (int i = 0; i < m_tiles.size(); ++i) {
+        if (cellRect(i, area).contains(pos))
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * \brief MosaicView::scaledImage
+ * Returns the frame of a tile scaled for its cell, rescaling only when the frame or the size changed.
+ * \param index Tile index.
+ * \param size Size of the image rect.
+ * \param fast Nearest-neighbour instead of smooth scaling, as chosen by the CPU governor.
+ * \return The scaled frame.
+ */
+const QImage &MosaicView::scaledImage(int index, const QSize &size, bool fast)
+{
+    MosaicTile &tile = m_tiles[index];
+    if (tile.scaled.isNull() || tile.scaledKey != tile.image.cacheKey() || tile.scaled.size() != size ||
+        tile.scaledFast != fast) {
+        // Frames are requested at cell size, so usually there is nothing to scale
+        tile.scaled = tile.image.size() == size
+            ? tile.image
+            : tile.image.scaled(size, Qt::IgnoreAspectRatio, fast ? Qt::FastTransformation : Qt::SmoothTransformation);
+        tile.scaledKey = tile.image.cacheKey();
+        tile.scaledFast = fast;
+    }
+    return tile.scaled;
+}
@@ -0,0 +1,71 @@
+#ifndef _mosaicView_H_
+#define _mosaicView_H_
+
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <QString>
+#include <QStringList>
+
+//--------------------------------------------------------------------------------
+// Mosaic mode: one widget shows several streams in a grid.
+// StreamServer multiplexes the streams over the widget's WebSocket and tags each
+// frame with its tile index. Every tile keeps its own frame, status and a copy
+// scaled to its cell, so a new frame of one camera rescales and repaints only
+// that cell.
+
+struct MosaicTile
+{
+    QString url;
+    QString name;                    // Drawn in the corner of the cell like the stream name box
+    QString status;                  // Drawn centered in the cell when not empty
+    QImage image;
+    bool imageIsStale = false;       // image comes from the frame cache, not from the live stream
+    qint64 staleServerTimestamp = 0;
+    qint64 lastFrameTimestamp = 0;   // Client time of the last frame, for the freeze check
+    qint64 lastServerTimestamp = 0;
+    qint64 delayMs = -1;
+    // Identity of the payload on screen, to skip repeated frames
+    size_t lastPayloadHash = 0;
+    qsizetype lastPayloadSize = -1;
+    quint64 frames = 0;
+    // CPU governor frame skipping counts per tile, so round-robin frames do not always skip the same tiles
+    quint64 skipCounter = 0;
+    // image scaled to the cell
+    QImage scaled;
+    qint64 scaledKey = 0;
+    bool scaledFast = false;
+};
+
+class MosaicView
+{
+  public:
+    static constexpr int kMaxTiles = 64;   // Tile index is one byte on the wire; 8 x 8 is the largest sensible wall
+    static constexpr int kSpacing = 2;     // Black gap between cells in px
+
+    // Tiles of URLs that stay in the list keep their frame and state
+    void setStreams(const QStringList &urls);
+    void setNames(const QStringList &names);
+    void setColumns(int columns);
+
+    int count() const { return m_tiles.size(); }
+    bool isEmpty() const { return m_tiles.isEmpty(); }
+    MosaicTile &tile(int index) { return m_tiles[index]; }
+    const MosaicTile &tile(int index) const { return m_tiles.at(index); }
+
+    // Grid actually used: the configured columns, or as square as possible if 0
+    int columns() const;
+    int rows() const;
+    QRect cellRect(int index, const QRect &area) const;
+    // Part of the cell the frame is drawn in, aspect ratio preserved and centered
+    QRect imageRect(int index, const QRect &area) const;
+    int tileAt(const QPoint &pos, const QRect &area) const;
+    const QImage &scaledImage(int index, const QSize &size, bool fast);
+
+  private:
+    QList<MosaicTile> m_tiles;
+    QStringList m_names;
+    int m_columns = 0;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include <shmTransport.hxx>
+
+//--------------------------------------------------------------------------------
+
+ShmFrameReader::ShmFrameReader(QObject *parent)
+  : QObject(parent)
+{
+}
+
+ShmFrameReader::~ShmFrameReader()
+{
+    close();
+}
+
+/**
+ * \brief ShmFrameReader::open
+ * Attaches to the server's frame ring and starts waiting for frame notifications.
+ * \param memoryKey Native key of the shared memory segment, as announced in shm_info.
+ * \param semaphoreKey Key of the system semaphore the server releases for this client.
+ * \return False if the segment cannot be attached or has an unexpected layout; see errorString().
+ */
+bool ShmFrameReader::open(const QString &memoryKey, const QString &semaphoreKey)
+{
+    close();
+    m_error.clear();
+
+    m_memory.setNativeKey(memoryKey);
+    if (!m_memory.attach(QSharedMemory::ReadOnly)) {
+        m_error = m_memory.errorString();
+        return false;
+    }
+
+    const ShmRingHeader *header = static_cast<const ShmRingHeader *>(m_memory.constData());
+    qint64 required = qint64(sizeof(ShmRingHeader));
+    if (m_memory.size() >= required && header->magic == kShmMagic && header->version == kShmVersion)
+        required += qint64(header->slotCount) * header->slotSize;
+    if (m_memory.size() < qint64(sizeof(ShmRingHeader)) || header->magic != kShmMagic ||
+        header->version != kShmVersion || header->slotCount == 0 ||
+        header->slotSize <= sizeof(ShmSlotHeader) || m_memory.size() < required) {
+        m_error = "Unexpected shared memory layout";
+        m_memory.detach();
+        return false;
+    }
+
+    m_semaphore.reset(new QSystemSemaphore(semaphoreKey, 0, QSystemSemaphore::Open));
+    if (m_semaphore->error() != QSystemSemaphore::NoError) {
+        m_error = m_semaphore->errorString();
+        m_semaphore.reset();
+        m_memory.detach();
+        return false;
+    }
+
+    m_notifierState.storeRelease(Running);
+    m_notifyPending.storeRelease(0);
+    m_lastSequence = header->writeSequence.load(std::memory_order_acquire);
+    m_skippedFrames = 0;
+    // Blocking wait on the semaphore; the signal reaches the GUI thread as a queued call
+    m_notifier = QThread::create([this]() {
+        while (m_notifierState.testAndSetOrdered(Running, Waiting)) {
+            bool acquired = m_semaphore->acquire();
+            if (!m_notifierState.testAndSetOrdered(Waiting, Running) || !acquired)
+                break; // Stopped: close() released once for the acquire that just returned
+            if (!m_notifyPending.fetchAndStoreAcquire(1))
+                emit frameAvailable();
+        }
+    });
+    m_notifier->start();
+    return true;
+}
+
+/**
+ * \brief ShmFrameReader::close
+ * Stops the notification thread and detaches from the shared memory.
+ */
+void ShmFrameReader::close()
+{
+    if (m_notifier) {
+        // Wake the notifier only if it is in, or committed to, acquire(); otherwise it sees
+        // the state before its next wait and the server's semaphore keeps no extra count
+        if (m_notifierState.fetchAndStoreOrdered(Stopped) == Waiting)
+            m_semaphore->release();
+        m_notifier->wait();
+        delete m_notifier;
+        m_notifier = nullptr;
+    }
+    m_semaphore.reset();
+    if (m_memory.isAttached())
+        m_memory.detach();
+}
+
+/**
+ * \brief ShmFrameReader::readLatest
+ * Reads the newest frame of the ring. JPEG payloads are decoded directly from the mapped slot,
+ * raw payloads are copied once into a new image. The slot's sequence numbers are checked after
+ * reading, so a frame overwritten by the server meanwhile is discarded.
+ * \param image Receives the decoded frame.
+ * \param serverTimestamp Receives the frame's server timestamp.
+ * \param jpeg Receives a copy of the compressed data, empty for raw frames.
+ * \return Decoded, NoFrame if there is nothing new or the read was torn, Failed on a decode error.
+ */
+ShmFrameReader::Result ShmFrameReader::readLatest(QImage &image, qint64 &serverTimestamp, QByteArray &jpeg)
+{
+    m_notifyPending.storeRelease(0);
+    if (!m_memory.isAttached())
+        return NoFrame;
+
+    const uchar *base = static_cast<const uchar *>(m_memory.constData());
+    const ShmRingHeader *header = reinterpret_cast<const ShmRingHeader *>(base);
+    quint64 sequence = header->writeSequence.load(std::memory_order_acquire);
+    if (sequence == 0 || sequence == m_lastSequence)
+        return NoFrame; // The sequence number identifies the frame, nothing new to decode
+
+    const uchar *slotBase = base + sizeof(ShmRingHeader) + (sequence % header->slotCount) * quint64(header->slotSize);
+    const ShmSlotHeader *slot = reinterpret_cast<const ShmSlotHeader *>(slotBase);
+    if (slot->sequenceEnd.load(std::memory_order_acquire) != sequence)
+        return NoFrame; // Already being rewritten
+
+    qint64 timestamp = slot->serverTimestamp;
+    quint32 format = slot->format;
+    quint32 width = slot->width;
+    quint32 height = slot->height;
+    quint32 bytesPerLine = slot->bytesPerLine;
+    quint32 payloadSize = slot->payloadSize;
+    const uchar *payload = slotBase + sizeof(ShmSlotHeader);
+    if (payloadSize > header->slotSize - sizeof(ShmSlotHeader))
+        return Failed;
+
+    QImage decoded;
+    QByteArray compressed;
+    if (format == Jpeg) {
+        if (decoded.loadFromData(payload, int(payloadSize), "JPEG"))
+            compressed = QByteArray(reinterpret_cast<const char *>(payload), qsizetype(payloadSize));
+    } else if (format == RawRgb32 && width > 0 && height > 0 && bytesPerLine >= width * 4 &&
+               quint64(bytesPerLine) * height <= payloadSize) {
+        decoded = QImage(payload, int(width), int(height), qsizetype(bytesPerLine), QImage::Format_RGB32).copy();
+    }
+
+    // Seqlock check: the writer bumps sequenceBegin before touching the slot again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequenceBegin.load(std::memory_order_relaxed) != sequence)
+        return NoFrame;
+
+    if (m_lastSequence != 0 && sequence > m_lastSequence + 1)
+        m_skippedFrames += sequence - m_lastSequence - 1;
+    m_lastSequence = sequence;
+    if (decoded.isNull())
+        return Failed;
+    image = decoded;
+    serverTimestamp = timestamp;
+    jpeg = compressed;
+    return Decoded;
+}
+
+/**
+ * \brief ShmFrameReader::skipLatest
+ * Marks the newest frame as read without decoding it, e.g. when the CPU governor drops frames.
+ */
+void ShmFrameReader::skipLatest()
+{
+    m_notifyPending.storeRelease(0);
+    if (!m_memory.isAttached())
+        return;
+    const ShmRingHeader *header = static_cast<const ShmRingHeader *>(m_memory.constData());
+    m_lastSequence = header->writeSequence.load(std::memory_order_acquire);
+}
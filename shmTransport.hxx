@@ -0,0 +1,98 @@
+#ifndef _shmTransport_H_
+#define _shmTransport_H_
+
+#include <QObject>
+#include <QSharedMemory>
+#include <QSystemSemaphore>
+#include <QAtomicInt>
+#include <QImage>
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+//--------------------------------------------------------------------------------
+// Shared-memory frame transport for a StreamServer on the same host.
+// The server owns a ring of fixed-size frame slots in a shared memory segment
+// and releases a per-client system semaphore after each written frame.
+// Slots are guarded like a seqlock: the writer stores sequenceBegin, the frame,
+// then sequenceEnd and finally the ring's writeSequence; a reader accepts a
+// slot only if both sequence numbers still match after reading it.
+// All fields are in host byte order.
+
+struct ShmRingHeader {
+    quint32 magic;                        // kShmMagic
+    quint32 version;                      // kShmVersion
+    quint32 slotCount;
+    quint32 slotSize;                     // Bytes per slot including its ShmSlotHeader
+    std::atomic<quint64> writeSequence;   // Sequence of the newest complete frame, 0 = none; slot = sequence % slotCount
+};
+
+struct ShmSlotHeader {
+    std::atomic<quint64> sequenceBegin;
+    qint64 serverTimestamp;               // ms since epoch, as in the WebSocket frame header
+    quint32 format;                       // ShmFrameReader::PayloadFormat
+    quint32 width;                        // Raw formats only
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 payloadSize;
+    quint32 reserved;
+    std::atomic<quint64> sequenceEnd;
+};
+
+// A lock-based atomic would use a process-local lock inside the shared segment
+static_assert(std::atomic<quint64>::is_always_lock_free, "Lock-free 64 bit atomics are required in shared memory");
+static_assert(sizeof(std::atomic<quint64>) == sizeof(quint64), "64 bit atomics must have the layout of quint64");
+
+class ShmFrameReader : public QObject
+{
+  Q_OBJECT
+
+  public:
+    enum PayloadFormat {
+        Jpeg = 0,
+        RawRgb32 = 1   // Already decoded pixels, QImage::Format_RGB32
+    };
+    enum Result {
+        NoFrame,       // Nothing new, or the slot was overwritten while reading
+        Decoded,
+        Failed         // The payload could not be decoded
+    };
+
+    static constexpr quint32 kShmMagic = 0x53454D46; // 'SEMF'
+    static constexpr quint32 kShmVersion = 1;
+
+    explicit ShmFrameReader(QObject *parent = nullptr);
+    ~ShmFrameReader();
+
+    bool open(const QString &memoryKey, const QString &semaphoreKey);
+    void close();
+    bool isOpen() const { return m_memory.isAttached(); }
+    QString errorString() const { return m_error; }
+
+    // Decodes the newest frame straight out of its slot. jpeg receives a copy of the
+    // compressed data (empty for raw frames) for the frame cache and snapshots.
+    Result readLatest(QImage &image, qint64 &serverTimestamp, QByteArray &jpeg);
+    // Marks the newest frame as read without decoding it
+    void skipLatest();
+    quint64 sequence() const { return m_lastSequence; }
+    quint64 skippedFrames() const { return m_skippedFrames; }
+
+  signals:
+    // Emitted from the notification thread, at most once until readLatest() is called
+    void frameAvailable();
+
+  private:
+    QSharedMemory m_memory;
+    std::unique_ptr<QSystemSemaphore> m_semaphore;
+    // The server's semaphore must not keep a count from close(), so the notifier is only woken
+    // by a release while it is committed to waiting
+    enum NotifierState { Running = 0, Waiting = 1, Stopped = 2 };
+    QThread *m_notifier = nullptr;
+    QAtomicInt m_notifierState;
+    QAtomicInt m_notifyPending;
+    quint64 m_lastSequence = 0;
+    quint64 m_skippedFrames = 0;  // Frames overwritten before they were read
+    QString m_error;
+};
+
+#endif
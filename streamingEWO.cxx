@@ -1,15 +1,28 @@
 #include <streamingEWO.hxx>
+#include <frameCache.hxx>
+#include <cpuGovernor.hxx>
 
 // TODO change to what you need
 #include <QPainter>
 #include <QBuffer>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QDateTime> // Required for QDateTime
+#include <QTimeZone>
 #include <QDebug> // For debug prints
 #include <QMouseEvent> // Required for mouse events
 #include <QSvgRenderer>
 #include <QNetworkInterface> // Required for getting local IP address
+#include <QtEndian>
+#include <QScreen>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QPointer>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <cmath>
 
 //--------------------------------------------------------------------------------
 
@@ -23,8 +36,85 @@ struct StatusMessages {
     const QString errorDecoding = "Error decoding image";
     const QString invalidFormat = "Invalid message format";
     const QString frozen = "Stream appears to be frozen";
+    const QString cachedFrame = "Cached frame from %1";
 };
 static const StatusMessages statusMsg;
+
+const qint64 kLatencyCutoffMs = 150;  // Frames older than this are not shown outside debug mode
+const qint64 kFrozenAfterMs = 500;    // A stream without frames for this long counts as frozen
+
+const double kMaxZoom = 8.0;          // Largest region-of-interest magnification
+const int kRoiDebounceMs = 150;       // Delay before a changed region is sent to the server
+const qreal kTouchPanThreshold = 8.0; // Movement in px before a touch counts as a pan instead of a tap
+
+// Tile mode frame types, sent in the byte after the timestamp
+const int kFrameHeaderSize = 8;       // Frames: big-endian qint64 server timestamp, then the JPEG
+const int kTileFrameHeaderSize = 9;   // Tile mode adds a frame type byte after the timestamp
+const char kTileFrameKey = 0;         // A complete JPEG follows
+const char kTileFrameDelta = 1;       // quint16 tile count, then per tile quint16 x, quint16 y, quint32 size, JPEG
+const int kKeyframeIntervalMs = 2000; // Periodic keyframes requested from the server in tile mode
+const int kKeyframeRequestMs = 1000;  // Minimum interval between explicit keyframe requests
+
+const double kReducedResolutionScale = 0.5; // Resolution requested at CpuGovernor::ReducedResolution
+
+const int kStandbyKeyframeIntervalMs = 2000; // Warm streams only decode keyframes at this interval
+const int kMaxWarmStreams = 8;
+
+const int kWsFragmentSize = 16384;    // StreamServer splits larger frames into WebSocket fragments of this size
+const double kDecodeSmoothing = 0.1;  // Weight of a new sample in the decode time averages
+
+const int kMosaicHeaderSize = 9;      // Mosaic frames: timestamp, then the tile index byte, then the JPEG
+const QLatin1String kMosaicCacheSuffix("#mosaic"); // Cell-sized frames are cached apart from full frames
+
+const int kShmSetupTimeoutMs = 2000;  // Wait for shm_info before falling back to WebSocket
+const int kMulticastSetupTimeoutMs = 2000; // Wait for multicast_info before falling back to WebSocket
+
+// Automatic transport selection
+const char kProbeMagic[] = "SPRB";    // UDP probe datagram: magic, quint32 probe id, quint16 index,
+const int kProbeDatagramSize = 20;    // quint16 count, qint64 server timestamp (big endian)
+const int kProbeCount = 20;           // Datagrams per probe burst
+const int kProbeIntervalMs = 10;      // Spacing of the burst, so it does not look like a single packet train
+const int kProbeTimeoutMs = 1000;     // Results are evaluated after this time
+const double kMaxProbeLoss = 0.05;    // UDP is only chosen with at most 5 % loss...
+const double kProbeDelayMarginMs = 5; // ...and a delay no worse than the WebSocket's plus this margin
+const int kReprobeIntervalMs = 120000;
+const int kMaxAutoFreezes = 2;        // Freezes on UDP before falling back to WebSocket until the next probe
+
+// Inserts a JPEG comment (COM) segment after SOI and any APPn segments, which JFIF and Exif
+// require to come first. Returns the data unchanged if it does not look like a JPEG.
+QByteArray insertJpegComment(const QByteArray &jpeg, const QByteArray &comment)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(jpeg.constData());
+    if (jpeg.size() < 4 || data[0] != 0xFF || data[1] != 0xD8 || comment.size() > 0xFFFF - 2)
+        return jpeg;
+    qsizetype pos = 2;
+    while (pos + 4 <= jpeg.size() && data[pos] == 0xFF && data[pos + 1] >= 0xE0 && data[pos + 1] <= 0xEF)
+        pos += 2 + qFromBigEndian<quint16>(data + pos + 2);
+    if (pos > jpeg.size())
+        return jpeg;
+    QByteArray segment(4, Qt::Uninitialized);
+    segment[0] = char(0xFF);
+    segment[1] = char(0xFE);
+    qToBigEndian<quint16>(quint16(comment.size() + 2), segment.data() + 2);
+    return jpeg.left(pos) + segment + comment + jpeg.mid(pos);
+}
+
+// Name of a transport as used in control messages and debug prints
+QString transportName(MyWidget::TransportProtocol protocol)
+{
+    switch (protocol) {
+        case MyWidget::UDP:
+            return "udp";
+        case MyWidget::Multicast:
+            return "multicast";
+        case MyWidget::SharedMemory:
+            return "shm";
+        case MyWidget::Auto:
+            return "auto";
+        default:
+            return "websocket";
+    }
+}
 }
 
 //--------------------------------------------------------------------------------
@@ -50,15 +140,59 @@ MyWidget::MyWidget(QWidget *parent)
     m_streamNameBoxPosition(TopLeft)
 {
   // Note: m_transport and m_udpPort are initialized in the header with default values
-  if (m_debugPrint) qDebug() << "[DEBUG] MyWidget constructor called. Initial UDP port:" << m_udpPort << "Transport:" << (m_transport == UDP ? "UDP" : "WebSocket");
+  if (m_debugPrint) qDebug() << "[DEBUG] MyWidget constructor called. Initial UDP port:" << m_udpPort << "Transport:" << transportName(m_transport);
   connect(m_webSocket, &QWebSocket::connected, this, &MyWidget::onConnected);
   connect(m_webSocket, &QWebSocket::disconnected, this, &MyWidget::onDisconnected);
-  connect(m_webSocket, &QWebSocket::binaryMessageReceived, this, &MyWidget::onBinaryMessageReceived);
+  // Fragments instead of whole messages, so a large frame is decoded while it arrives
+  connect(m_webSocket, &QWebSocket::binaryFrameReceived, this, &MyWidget::onBinaryFrameReceived);
   connect(m_webSocket, &QWebSocket::textMessageReceived, this, &MyWidget::onTextMessageReceived);
 
   connect(&m_connectionStatusTimer, &QTimer::timeout, this, &MyWidget::checkConnectionStatus);
   m_connectionStatusTimer.start(500); // Check connection status every 0.5 seconds
 
+  // Region-of-interest changes are sent once a gesture pauses
+  m_roiTimer.setSingleShot(true);
+  m_roiTimer.setInterval(kRoiDebounceMs);
+  connect(&m_roiTimer, &QTimer::timeout, this, &MyWidget::sendRoi);
+
+  // The server scales mosaic streams to the cell size; tell it once a resize is over
+  m_mosaicLayoutTimer.setSingleShot(true);
+  m_mosaicLayoutTimer.setInterval(kRoiDebounceMs);
+  connect(&m_mosaicLayoutTimer, &QTimer::timeout, this, [this]() {
+      if (mosaicActive() && m_webSocket->state() == QAbstractSocket::ConnectedState)
+          sendSetStream();
+  });
+
+  // New frames are presented by a timer so bursts are coalesced into one paint
+  m_presentTimer.setSingleShot(true);
+  m_presentTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_presentTimer, &QTimer::timeout, this, &MyWidget::present);
+
+  // A server without shared memory support never answers with shm_info
+  m_shmSetupTimer.setSingleShot(true);
+  m_shmSetupTimer.setInterval(kShmSetupTimeoutMs);
+  connect(&m_shmSetupTimer, &QTimer::timeout, this, [this]() {
+      fallbackToWebSocket("no shm_info from server");
+  });
+  // Likewise a server without multicast support never assigns a group
+  m_multicastSetupTimer.setSingleShot(true);
+  m_multicastSetupTimer.setInterval(kMulticastSetupTimeoutMs);
+  connect(&m_multicastSetupTimer, &QTimer::timeout, this, [this]() {
+      fallbackToWebSocket("no multicast_info from server");
+  });
+
+  // Auto transport: evaluate a probe burst, and probe again from time to time
+  m_probeTimer.setSingleShot(true);
+  m_probeTimer.setInterval(kProbeTimeoutMs);
+  connect(&m_probeTimer, &QTimer::timeout, this, &MyWidget::finishTransportProbe);
+  m_reprobeTimer.setSingleShot(true);
+  m_reprobeTimer.setInterval(kReprobeIntervalMs);
+  connect(&m_reprobeTimer, &QTimer::timeout, this, &MyWidget::startTransportProbe);
+
+  // Decode and paint time is accounted against the process-wide CPU budget
+  CpuGovernor::instance().registerClient(this, m_priority);
+  connect(&CpuGovernor::instance(), &CpuGovernor::levelChanged, this, &MyWidget::onGovernorLevelChanged);
+
   // Set initial background to green
   QPalette pal = palette();
   pal.setColor(backgroundRole(), Qt::green);
@@ -73,12 +207,19 @@ MyWidget::MyWidget(QWidget *parent)
 
 MyWidget::~MyWidget()
 {
+    // Make sure the newest frame of this stream is on disk for the next panel open
+    if (m_frameCacheEnabled)
+        FrameCache::instance().flush(m_rtspStreamUrl);
+    CpuGovernor::instance().unregisterClient(this);
     // Safely close WebSocket connection
     if (m_webSocket) {
         m_webSocket->close();
     }
     // Safely close UDP socket
     closeUdpSocket();
+    // Stop the shared memory notification thread before the widget goes away
+    if (m_shmReader)
+        m_shmReader->close();
     // Stop connection status timer
     m_connectionStatusTimer.stop();
     // Stop reconnect timer if exists
@@ -99,7 +240,7 @@ void MyWidget::setWebSocketUrl(const QString &url)
         return; // Avoid unnecessary update
     if (m_debugPrint) qDebug() << "[DEBUG] setWebSocketUrl called with" << url;
     m_webSocketUrl = url;
-    if (m_inGedi) return; // Do not connect in editor
+    if (m_inGedi || m_batchUpdate) return; // Do not connect in editor
     if (!m_webSocketUrl.isEmpty() && m_webSocket->state() == QAbstractSocket::UnconnectedState)
     {        
         m_webSocket->open(QUrl(m_webSocketUrl));
@@ -118,20 +259,33 @@ void MyWidget::setRtspStreamUrl(const QString &url)
         return; // Avoid unnecessary update
     if (m_debugPrint) qDebug() << "[DEBUG] setRtspStreamUrl called with" << url;
     m_rtspStreamUrl = url;
+    // A new camera starts unzoomed, the server resets the region with set_stream
+    m_zoom = 1.0;
+    m_zoomCenter = QPointF(0.5, 0.5);
+    m_activeRoi = QRectF(0, 0, 1, 1);
+    m_roiTimer.stop();
+    // The calibration belongs to the previous camera
+    if (m_lensRemap.hasCalibration()) {
+        m_lensRemap.clear();
+        m_undistortionAvailable = false;
+    }
+    if (mosaicActive())
+        return; // Used again once the mosaic is cleared
+    // Show the last known picture of the new stream until its first live frame arrives
+    if (!m_inGedi)
+        showCachedFrame();
+    if (m_batchUpdate)
+        return;
+    // The multicast group belongs to the previous stream; the server assigns a new one
+    if (m_activeTransport == Multicast)
+        closeUdpSocket();
     if (m_webSocket->state() == QAbstractSocket::ConnectedState && !m_rtspStreamUrl.isEmpty())
     {
-        QJsonObject message;
-        message["type"] = "control";
-        message["command"] = "set_stream";
-        message["url"] = m_rtspStreamUrl;
-        message["transport"] = (m_transport == UDP ? "udp" : "websocket");
-        if (m_frameDropRatio > 1) {
-            message["frame_drop_ratio"] = m_frameDropRatio;
-        }
-        if (m_transport == UDP) {
-            message["udp_port"] = m_udpPort;
-        }
-        m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+        sendSetStream();
+        // Connected before the URL was set: Auto has not probed yet. Once probing, the
+        // periodic re-probe covers later stream switches.
+        if (!m_reprobeTimer.isActive())
+            startTransportProbe();
     }
 }
 
@@ -173,41 +327,348 @@ bool MyWidget::getDebugPrint() const
  */
 void MyWidget::onConnected()
 {
-    if (m_debugPrint) qDebug() << "[DEBUG] onConnected called. RTSP URL:" << m_rtspStreamUrl << "Transport:" << (m_transport == UDP ? "UDP" : "WebSocket") << "UDP Port:" << m_udpPort;
+    if (m_debugPrint) qDebug() << "[DEBUG] onConnected called. RTSP URL:" << m_rtspStreamUrl << "Transport:" << transportName(m_transport) << "UDP Port:" << m_udpPort;
     m_statusText = statusMsg.connecting;
     m_undistortionAvailable = false; // Reset on new connection
     m_undistortionEnabled = false;
     m_undistortionMode = 0;
-    if (!m_rtspStreamUrl.isEmpty())
+    m_lensRemap.clear();              // The server sends the calibration again
+    m_warmStreams.clear();            // Standby streams are per connection
+    m_activeRoi = QRectF(0, 0, 1, 1); // The server starts with the whole frame
+    // Try the configured transport again after a fallback; Auto starts on the WebSocket
+    m_activeTransport = initialTransport();
+    for (int i = 0; i < m_mosaic.count(); ++i)
+        setMosaicTileStatus(m_mosaic.tile(i), statusMsg.connecting);
+    if (hasStream())
     {
-        QJsonObject message;
-        message["type"] = "control";
-        message["command"] = "set_stream";
-        message["url"] = m_rtspStreamUrl;
-        message["transport"] = (m_transport == UDP ? "udp" : "websocket");
-        if (m_frameDropRatio > 1) {
-            message["frame_drop_ratio"] = m_frameDropRatio;
-        }
-        if (m_transport == UDP) {
-            message["udp_port"] = m_udpPort;
-            
-            // Get the client's local IP address
-            QString localIp = getLocalIpAddress();
-            if (!localIp.isEmpty()) {
-                message["udp_ip"] = localIp;
-                if (m_debugPrint) qDebug() << "[DEBUG] Using local IP for UDP:" << localIp;
-            } else {
-                if (m_debugPrint) qDebug() << "[DEBUG] Warning: Could not determine local IP address";
-            }
-            
-            setupUdpSocket();
+        if (m_activeTransport == UDP && !setupUdpSocket()) {
+            m_activeTransport = WebSocket; // Port in use or not allowed; frames still arrive
         }
-        if (m_debugPrint) qDebug() << "[DEBUG] Sending control message:" << QJsonDocument(message).toJson(QJsonDocument::Compact);
-        m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+        sendSetStream();
+        startTransportProbe();
     }
     update();
 }
 
+/**
+ * \brief MyWidget::buildSetStreamMessage
+ * Builds the set_stream control message for the current stream and transport settings,
+ * or the set_mosaic message in mosaic mode.
+ * \return The control message as a QJsonObject.
+ */
+QJsonObject MyWidget::buildSetStreamMessage()
+{
+    if (mosaicActive())
+        return buildSetMosaicMessage();
+    QJsonObject message;
+    message["type"] = "control";
+    message["command"] = "set_stream";
+    message["url"] = m_rtspStreamUrl;
+    if (m_warmStreams.contains(m_rtspStreamUrl)) {
+        message["promote_standby"] = true; // The source is already open on the server
+    }
+    message["transport"] = transportName(m_activeTransport);
+    // The widget can undistort itself if the server sends camera_calibration
+    message["client_undistortion"] = true;
+    if (m_frameDropRatio > 1) {
+        message["frame_drop_ratio"] = m_frameDropRatio;
+    }
+    if (m_maxFps > 0) {
+        message["max_fps"] = m_maxFps; // The server does not send frames above the cap
+    }
+    if (creditsActive()) {
+        message["credits"] = m_flowControlCredits; // Initial window, replenished with credit messages
+        message["credit_epoch"] = qint64(m_creditEpoch);
+    }
+    if (m_activeTransport == WebSocket) {
+        message["fragment_size"] = kWsFragmentSize;
+    }
+    if ((m_activeTransport == UDP || m_activeTransport == Multicast) && m_fecGroupSize > 0) {
+        QJsonObject fec;
+        fec["scheme"] = "xor";
+        fec["group_size"] = m_fecGroupSize;
+        message["fec"] = fec;
+    }
+    if (m_activeTransport == UDP) {
+        message["udp_port"] = m_udpPort;
+
+        // Get the client's local IP address
+        QString localIp = getLocalIpAddress();
+        if (!localIp.isEmpty()) {
+            message["udp_ip"] = localIp;
+            if (m_debugPrint) qDebug() << "[DEBUG] Using local IP for UDP:" << localIp;
+        } else {
+            if (m_debugPrint) qDebug() << "[DEBUG] Warning: Could not determine local IP address";
+        }
+    }
+    // For multicast the server answers with a multicast_info message carrying the group and port,
+    // for shared memory with shm_info carrying the keys of the frame ring and its semaphore
+    if (m_activeTransport == SharedMemory) {
+        QJsonArray formats;
+        formats.append("jpeg");
+        formats.append("rgb32"); // Raw pixels save the decode when the server has them anyway
+        message["shm_formats"] = formats;
+    }
+    if (m_zoom > 1.0) {
+        message["roi"] = roiToJson();
+    }
+    if (m_governorLevel >= CpuGovernor::ReducedResolution) {
+        message["resolution_scale"] = kReducedResolutionScale;
+    }
+    if (m_tileUpdates && m_activeTransport != SharedMemory) {
+        message["frame_mode"] = "tiles";
+        message["keyframe_interval_ms"] = kKeyframeIntervalMs;
+    }
+    return message;
+}
+
+/**
+ * \brief MyWidget::sendSetStream
+ * Sends the set_stream control message over the WebSocket.
+ */
+void MyWidget::sendSetStream()
+{
+    m_fec.reset(); // Fragments of the previous stream are of no use
+    m_pendingCredits = 0; // set_stream grants a fresh window
+    if (creditsActive())
+        m_creditEpoch++;  // Frames still in flight under the old window must not be credited on top of it
+    if (m_activeTransport == SharedMemory) {
+        // The server announces the ring of the new stream with shm_info
+        if (m_shmReader)
+            m_shmReader->close();
+        m_shmSetupTimer.start();
+    }
+    if (m_activeTransport == Multicast && m_multicastGroup.isNull())
+        m_multicastSetupTimer.start(); // The server assigns the group with multicast_info
+    QJsonObject message = buildSetStreamMessage();
+    if (message.contains("promote_standby"))
+        m_standbyPromotions++; // Served from the warm source, the first frame follows within one interval
+    QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    if (m_debugPrint) qDebug() << "[DEBUG] Sending control message:" << json;
+    m_webSocket->sendTextMessage(QString::fromUtf8(json));
+    // The promoted stream is no longer standby, and the new active one is no candidate
+    sendStandby();
+}
+
+/**
+ * \brief MyWidget::warmStreams
+ * Returns the standby streams to keep warm: the configured list without the active stream and
+ * duplicates, limited to maxWarmStreams.
+ * \return List of RTSP URLs.
+ */
+QStringList MyWidget::warmStreams() const
+{
+    QStringList urls;
+    if (mosaicActive())
+        return urls; // The mosaic streams are all live
+    for (const QString &url : m_standbyStreams) {
+        if (urls.size() >= m_maxWarmStreams)
+            break;
+        if (!url.isEmpty() && url != m_rtspStreamUrl && !urls.contains(url))
+            urls.append(url);
+    }
+    return urls;
+}
+
+/**
+ * \brief MyWidget::sendStandby
+ * Tells the server which streams to keep warm, if that changed since the last set_standby.
+ */
+void MyWidget::sendStandby()
+{
+    QStringList urls = warmStreams();
+    if (urls == m_warmStreams || m_webSocket->state() != QAbstractSocket::ConnectedState)
+        return;
+    QJsonObject message;
+    message["type"] = "control";
+    message["command"] = "set_standby";
+    message["urls"] = QJsonArray::fromStringList(urls);
+    message["mode"] = "keyframes";
+    message["keyframe_interval_ms"] = kStandbyKeyframeIntervalMs;
+    if (m_debugPrint) qDebug() << "[DEBUG] Keeping standby streams warm:" << urls;
+    m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    m_warmStreams = urls;
+}
+
+/**
+ * \brief MyWidget::hasStream
+ * Returns whether there is anything to request from the server: a stream or a mosaic.
+ */
+bool MyWidget::hasStream() const
+{
+    return !m_rtspStreamUrl.isEmpty() || mosaicActive();
+}
+
+bool MyWidget::mosaicActive() const
+{
+    return !m_mosaic.isEmpty();
+}
+
+/**
+ * \brief MyWidget::initialTransport
+ * Returns the transport to start a connection with. Auto starts on the WebSocket until a probe
+ * has chosen, and a mosaic is always multiplexed over the WebSocket.
+ */
+MyWidget::TransportProtocol MyWidget::initialTransport() const
+{
+    return (m_transport == Auto || mosaicActive()) ? WebSocket : m_transport;
+}
+
+/**
+ * \brief MyWidget::buildSetMosaicMessage
+ * Builds the set_mosaic control message. The server sends the frames of all streams over the
+ * WebSocket, each scaled to the cell size and tagged with its tile index.
+ * \return The control message as a QJsonObject.
+ */
+QJsonObject MyWidget::buildSetMosaicMessage() const
+{
+    QSizeF cellSize = QSizeF(m_mosaic.cellRect(0, rect()).size()) * devicePixelRatioF();
+    if (m_governorLevel >= CpuGovernor::ReducedResolution)
+        cellSize *= kReducedResolutionScale;
+    QJsonObject message;
+    message["type"] = "control";
+    message["command"] = "set_mosaic";
+    message["urls"] = QJsonArray::fromStringList(m_mosaicStreams.mid(0, MosaicView::kMaxTiles));
+    message["transport"] = transportName(WebSocket);
+    // A wall of cameras then costs about as many pixels as one camera at full size
+    message["max_width"] = qMax(1, qRound(cellSize.width()));
+    message["max_height"] = qMax(1, qRound(cellSize.height()));
+    if (m_frameDropRatio > 1) {
+        message["frame_drop_ratio"] = m_frameDropRatio;
+    }
+    if (m_maxFps > 0) {
+        message["max_fps"] = m_maxFps; // Per stream
+    }
+    return message;
+}
+
+/**
+ * \brief MyWidget::handleMosaicFrame
+ * Decodes a mosaic frame into its tile and repaints only that tile's cell.
+ * \param message Binary message: 8 byte timestamp, tile index byte, JPEG data.
+ */
+void MyWidget::handleMosaicFrame(const QByteArray &message)
+{
+    QElapsedTimer cpuTimer; // Time on the GUI thread, accounted to the CPU governor
+    cpuTimer.start();
+    int index = message.size() > kMosaicHeaderSize ? quint8(message.at(kFrameHeaderSize)) : -1;
+    if (index < 0 || index >= m_mosaic.count()) {
+        if (m_debugPrint) qDebug() << "[DEBUG] Ignoring mosaic frame for tile" << index << "size:" << message.size();
+        return; // Malformed, or sent before the server applied the last set_mosaic
+    }
+    MosaicTile &tile = m_mosaic.tile(index);
+    QByteArrayView imageData = QByteArrayView(message).sliced(kMosaicHeaderSize);
+    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
+    tile.lastServerTimestamp = qFromBigEndian<qint64>(message.constData());
+    tile.delayMs = currentTime - tile.lastServerTimestamp;
+    // The widget-wide figures follow the newest frame of any tile
+    m_lastServerTimestamp = tile.lastServerTimestamp;
+    m_currentDelayMs = tile.delayMs;
+    m_lastFrameTimestamp = currentTime;
+    m_statusText = QString();
+
+    qint64 prevImageKey = tile.image.cacheKey();
+    QString prevStatus = tile.status;
+    size_t payloadHash = qHash(imageData);
+    if (!m_debugMode && tile.delayMs > kLatencyCutoffMs) {
+        setMosaicTileStatus(tile, statusMsg.considerableLatency);
+    } else if (!tile.image.isNull() && !tile.imageIsStale && imageData.size() == tile.lastPayloadSize &&
+               payloadHash == tile.lastPayloadHash) {
+        // Same payload as the frame on screen: skip decode and repaint
+        m_duplicateFrames++;
+        tile.lastFrameTimestamp = currentTime;
+    } else if (m_governorLevel >= CpuGovernor::SkipFrames && (tile.skipCounter++ % 2) != 0) {
+        // Over the CPU budget: drop every second frame of the tile without decoding it
+        m_governorSkippedFrames++;
+        tile.lastFrameTimestamp = currentTime;
+    } else {
+        QImage image;
+        if (image.loadFromData(imageData, "JPEG")) {
+            tile.image = image;
+            tile.imageIsStale = false;
+            tile.status = QString();
+            tile.lastFrameTimestamp = currentTime;
+            tile.lastPayloadHash = payloadHash;
+            tile.lastPayloadSize = imageData.size();
+            tile.frames++;
+            if (m_frameCacheEnabled)
+                FrameCache::instance().store(tile.url + kMosaicCacheSuffix, imageData.toByteArray(), tile.lastServerTimestamp);
+        } else {
+            if (m_debugPrint) qDebug() << "[DEBUG] Failed to load mosaic tile" << index << "from JPEG data";
+            setMosaicTileStatus(tile, statusMsg.errorDecoding);
+        }
+    }
+    if (m_debugMode) {
+        schedulePresent(rect()); // The overlay shows the delay of every frame
+    } else if (prevImageKey != tile.image.cacheKey() || prevStatus != tile.status) {
+        // The other tiles are unchanged and are not repainted
+        schedulePresent(m_mosaic.cellRect(index, rect()));
+    }
+    CpuGovernor::instance().addUsage(this, cpuTimer.nsecsElapsed());
+}
+
+/**
+ * \brief MyWidget::setMosaicTileStatus
+ * Sets the status of a mosaic tile; as for the single stream, a live frame is no longer shown
+ * with a status, a cached one stays visible.
+ * \param tile The tile.
+ * \param status The status message.
+ * \return True if the tile must be repainted.
+ */
+bool MyWidget::setMosaicTileStatus(MosaicTile &tile, const QString &status)
+{
+    if (tile.status == status && (tile.image.isNull() || tile.imageIsStale))
+        return false;
+    tile.status = status;
+    if (!tile.imageIsStale)
+        tile.image = QImage();
+    return true;
+}
+
+/**
+ * \brief MyWidget::showCachedMosaicTile
+ * Shows the cached last frame of a tile's stream, marked as stale. A frame that is not in memory
+ * is loaded from disk in the background and shown if the tile still has no frame by then.
+ * \param tile The tile.
+ * \return True if a cached frame was in memory and is shown.
+ */
+bool MyWidget::showCachedMosaicTile(MosaicTile &tile)
+{
+    if (!m_frameCacheEnabled || !tile.image.isNull())
+        return false;
+    // The cell-sized frame first, else the full frame, which is scaled to the cell when painted
+    QStringList keys = QStringList() << tile.url + kMosaicCacheSuffix << tile.url;
+    qint64 serverTimestamp = 0;
+    QByteArray jpeg;
+    for (const QString &key : keys) {
+        jpeg = FrameCache::instance().lookup(key, &serverTimestamp);
+        if (!jpeg.isEmpty())
+            break;
+    }
+    if (jpeg.isEmpty()) {
+        QString url = tile.url;
+        FrameCache::instance().fetch(keys, this, [this, url](const QByteArray &jpeg, qint64 serverTimestamp) {
+            // The tiles may have been rearranged meanwhile
+            for (int i = 0; i < m_mosaic.count(); ++i) {
+                MosaicTile &tile = m_mosaic.tile(i);
+                if (tile.url == url && tile.image.isNull() && showCachedMosaicJpeg(tile, jpeg, serverTimestamp))
+                    update(m_mosaic.cellRect(i, rect()));
+            }
+        });
+        return false;
+    }
+    return showCachedMosaicJpeg(tile, jpeg, serverTimestamp);
+}
+
+bool MyWidget::showCachedMosaicJpeg(MosaicTile &tile, const QByteArray &jpeg, qint64 serverTimestamp)
+{
+    if (!tile.image.loadFromData(jpeg, "JPEG"))
+        return false;
+    tile.imageIsStale = true;
+    tile.staleServerTimestamp = serverTimestamp;
+    return true;
+}
+
 /**
  * \brief MyWidget::onDisconnected
  * Slot called when the WebSocket is disconnected. Updates status and attempts reconnect if needed.
@@ -215,14 +676,32 @@ void MyWidget::onConnected()
 void MyWidget::onDisconnected()
 {
     if (m_debugPrint) qDebug() << "[DEBUG] onDisconnected called.";
+    if (m_activeTransport == Multicast || m_transport == Auto)
+        closeUdpSocket(); // Leave the group, a new one is assigned after reconnecting
+    m_shmSetupTimer.stop();
+    m_multicastSetupTimer.stop();
+    m_probeTimer.stop();
+    m_reprobeTimer.stop();
+    m_probeActive = false;
+    m_warmStreams.clear();
+    m_incrementalDecoder.abort(); // The rest of the message is not going to arrive
+    m_messageComplete = true;
+    if (m_shmReader)
+        m_shmReader->close();
     m_undistortionAvailable = false;
     m_undistortionEnabled = false;
     m_undistortionMode = 0;
-    if (m_statusText != statusMsg.noConnection || !m_image.isNull()) {
+    bool needUpdate = false;
+    for (int i = 0; i < m_mosaic.count(); ++i)
+        needUpdate |= setMosaicTileStatus(m_mosaic.tile(i), statusMsg.noConnection);
+    if (m_statusText != statusMsg.noConnection || (!m_image.isNull() && !m_imageIsStale)) {
         m_statusText = statusMsg.noConnection;
-        m_image = QImage(); // Clear image
-        update();
+        if (!m_imageIsStale)
+            m_image = QImage(); // Clear image, a cached frame stays visible as it is marked stale
+        needUpdate = true;
     }
+    if (needUpdate)
+        update();
     // Attempt to reconnect if URL is set
     if (m_inGedi) return; // Do not reconnect in editor
     if (!m_webSocketUrl.isEmpty()) {
@@ -240,48 +719,177 @@ void MyWidget::onDisconnected()
     }
 }
 
+/**
+ * \brief MyWidget::onBinaryFrameReceived
+ * Slot called for each fragment of a binary WebSocket message. A message of one fragment is
+ * handled as it is; the fragments of a larger one are collected in the decoder's buffer. For a
+ * full JPEG frame the decode starts with the first fragment; the complete message then goes to
+ * onBinaryMessageReceived.
+ * \param frame Payload of the fragment.
+ * \param isLastFrame True for the last fragment of the message.
+ */
+void MyWidget::onBinaryFrameReceived(const QByteArray &frame, bool isLastFrame)
+{
+    bool firstFragment = m_messageComplete;
+    if (firstFragment && isLastFrame) {
+        onBinaryMessageReceived(frame); // Nothing to overlap, and no copy is needed
+        return;
+    }
+    if (firstFragment) {
+        m_incrementalDecoder.reset();
+        m_messageComplete = false;
+    }
+    m_incrementalDecoder.append(frame);
+    if (!isLastFrame) {
+        if (firstFragment && incrementalDecodeWanted())
+            m_incrementalDecoder.startDecode(frameHeaderSize());
+        return;
+    }
+    m_messageComplete = true;
+    m_incrementalMessage = m_incrementalDecoder.isDecoding();
+    onBinaryMessageReceived(m_incrementalDecoder.message());
+    m_incrementalMessage = false;
+    m_incrementalDecoder.abort(); // Not used after all: duplicate, skipped or over the latency cutoff
+}
+
+/**
+ * \brief MyWidget::incrementalDecodeWanted
+ * Decides from the first fragment whether the frame should be decoded while it arrives: only
+ * full JPEG frames that onBinaryMessageReceived is likely to decode.
+ * \return True to start the incremental decode.
+ */
+bool MyWidget::incrementalDecodeWanted() const
+{
+    const QByteArray &message = m_incrementalDecoder.message();
+    int headerSize = frameHeaderSize();
+    if (mosaicActive() || message.size() <= headerSize || (m_tileUpdates && message.at(kFrameHeaderSize) != kTileFrameKey))
+        return false;
+    if (!m_tileUpdates && m_governorLevel >= CpuGovernor::SkipFrames && (m_governorFrameCounter % 2) != 0)
+        return false; // This frame will be skipped
+    // A frozen source repeats the frame on screen, so its start matches the last payload
+    return !m_lastPayload.startsWith(QByteArrayView(message).sliced(headerSize));
+}
+
+/**
+ * \brief MyWidget::decodeFrame
+ * Decodes a full JPEG frame, or collects the result of the incremental decode for it.
+ * \param imageData The JPEG data.
+ * \param image Receives the frame.
+ * \return True on success.
+ */
+bool MyWidget::decodeFrame(QByteArrayView imageData, QImage &image)
+{
+    if (!m_incrementalMessage)
+        return image.loadFromData(imageData, "JPEG");
+    QElapsedTimer tailTimer;
+    tailTimer.start();
+    bool ok = m_incrementalDecoder.finish(image);
+    qint64 decodeNsecs = m_incrementalDecoder.lastDecodeNsecs();
+    qint64 tailNsecs = tailTimer.nsecsElapsed();
+    // The part decoded before the last fragment ran on a worker; it still counts against the budget
+    CpuGovernor::instance().addUsage(this, qMax<qint64>(0, decodeNsecs - tailNsecs));
+    double weight = m_incrementalDecodes++ == 0 ? 1.0 : kDecodeSmoothing;
+    m_decodeNsecsAvg += weight * (decodeNsecs - m_decodeNsecsAvg);
+    m_decodeTailNsecsAvg += weight * (tailNsecs - m_decodeTailNsecsAvg);
+    return ok;
+}
+
+/**
+ * \brief MyWidget::frameHeaderSize
+ * \return Size of the header in front of the image data of a single-stream frame.
+ */
+int MyWidget::frameHeaderSize() const
+{
+    return m_tileUpdates ? kTileFrameHeaderSize : kFrameHeaderSize;
+}
+
 /**
  * \brief MyWidget::onBinaryMessageReceived
  * Slot called when a binary message is received. Decodes the image and updates status/delay.
  * \param message The received binary message as a QByteArray. The first 8 bytes are expected to be a qint64 timestamp, followed by JPEG image data.
+ * In tile mode a frame type byte follows the timestamp; delta frames carry only the changed tiles.
  */
 void MyWidget::onBinaryMessageReceived(const QByteArray &message)
 {
     if (m_debugPrint) qDebug() << "[DEBUG] onBinaryMessageReceived called. Message size:" << message.size();
+    if (mosaicActive()) {
+        handleMosaicFrame(message);
+        return;
+    }
+    QElapsedTimer cpuTimer; // Time on the GUI thread, accounted to the CPU governor
+    cpuTimer.start();
+    // Any live message ends the display of the cached frame
+    if (m_imageIsStale) {
+        m_imageIsStale = false;
+        m_image = QImage();
+    }
     qint64 prevDelay = m_currentDelayMs;
-    QImage prevImage = m_image;
+    qint64 prevImageKey = m_image.cacheKey(); // Changes whenever m_image is replaced or painted on
     QString prevStatus = m_statusText;
+    int headerSize = frameHeaderSize();
+    bool isDelta = false;
+    QRegion dirtyRegion; // Widget area changed by a delta frame
 
     // Assuming the first 8 bytes are the timestamp (qint64)
-    if (message.size() > 8) {
-        QByteArray timestampData = message.left(8);
-        QByteArray imageData = message.mid(8);
+    if (message.size() > headerSize) {
+        // A view into the message: the payload is only copied for a frame that is kept
+        QByteArrayView imageData = QByteArrayView(message).sliced(headerSize);
+        isDelta = m_tileUpdates && message.at(kFrameHeaderSize) == kTileFrameDelta;
         
         if (m_debugPrint) {
-            qDebug() << "[DEBUG] Timestamp bytes:" << timestampData.toHex();
-            qDebug() << "[DEBUG] Image data size:" << imageData.size() << "First few bytes:" << imageData.left(16).toHex();
+            qDebug() << "[DEBUG] Timestamp bytes:" << message.first(kFrameHeaderSize).toHex();
+            qDebug() << "[DEBUG] Image data size:" << imageData.size() << "First few bytes:" << imageData.first(qMin<qsizetype>(16, imageData.size())).toByteArray().toHex();
         }
 
-        
-        QDataStream tsStream(timestampData);
-        tsStream >> m_lastServerTimestamp;
+        m_lastServerTimestamp = qFromBigEndian<qint64>(message.constData());
 
         qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
         m_currentDelayMs = currentTime - m_lastServerTimestamp; // Store current delay
         if (m_debugPrint) qDebug() << "[DEBUG] onBinaryMessageReceived called. Current time, received time and delay:" << currentTime <<", " << m_lastServerTimestamp << ", " << m_currentDelayMs;
 
-        bool overCutoff = m_currentDelayMs > 150;
+        // Frozen or static RTSP sources repeat the same JPEG; its hash identifies the frame
+        size_t payloadHash = isDelta ? 0 : qHash(imageData);
+
+        bool overCutoff = m_currentDelayMs > kLatencyCutoffMs;
         if (!m_debugMode && overCutoff) {
             if (m_statusText != statusMsg.considerableLatency) {
                 m_statusText = statusMsg.considerableLatency;
                 m_image = QImage(); // Clear image
             }
+        } else if (!isDelta && !m_image.isNull() && imageData.size() == m_lastPayloadSize && payloadHash == m_lastPayloadHash) {
+            // Same payload as the frame on screen: skip decode and repaint
+            m_duplicateFrames++;
+            m_lastFrameTimestamp = currentTime; // The stream is alive
+        } else if ((isDelta || !m_tileUpdates) && m_governorLevel >= CpuGovernor::SkipFrames &&
+                   (m_governorFrameCounter++ % 2) != 0) {
+            // Over the CPU budget: drop every second frame without decoding it. In tile mode only
+            // deltas are dropped, a skipped keyframe would leave the following tiles without their base.
+            m_governorSkippedFrames++;
+            m_lastFrameTimestamp = currentTime; // The stream is alive, only not shown
+            if (isDelta)
+                m_skippedTiles = true;
+        } else if (isDelta && m_image.isNull()) {
+            // Tiles need a base frame to be patched into
+            requestKeyframe();
         } else {
-            if (m_image.loadFromData(imageData, "JPEG")) {
-                if (m_debugPrint) qDebug() << "[DEBUG] Image loaded successfully from JPEG data";
+            if (isDelta ? applyTileUpdate(imageData, dirtyRegion) : decodeFrame(imageData, m_image)) {
+                if (m_debugPrint) qDebug() << "[DEBUG] Image loaded successfully from JPEG data" << (isDelta ? "(tiles)" : "");
                 if (!m_statusText.isEmpty())
                     m_statusText = QString(); // Clear status text if image is successfully loaded
                 m_lastFrameTimestamp = currentTime; // Store timestamp of the valid frame
+                if (m_tileUpdates && !isDelta && m_image.format() != QImage::Format_RGB32)
+                    m_image.convertTo(QImage::Format_RGB32); // Tiles are painted into the keyframe
+                if (!isDelta)
+                    m_skippedTiles = false;
+                // The one copy of the payload, shared by the cache and snapshots
+                m_lastPayload = isDelta ? QByteArray() : imageData.toByteArray();
+                // A cropped frame would later be shown as the whole camera picture
+                if (m_frameCacheEnabled && !isDelta && m_activeRoi == QRectF(0, 0, 1, 1))
+                    FrameCache::instance().store(m_rtspStreamUrl, m_lastPayload, m_lastServerTimestamp);
+                // After tiles m_image no longer matches any single payload
+                m_lastPayloadHash = payloadHash;
+                m_lastPayloadSize = isDelta ? -1 : imageData.size();
+                m_lastPayloadTimestamp = m_lastServerTimestamp;
             } else {
                 if (m_debugPrint) qDebug() << "[DEBUG] Failed to load image from JPEG data";
                 if (m_statusText != statusMsg.errorDecoding) {
@@ -300,12 +908,21 @@ void MyWidget::onBinaryMessageReceived(const QByteArray &message)
         m_currentDelayMs = -1; // Indicate invalid delay
         m_overLatencyCutoff = false;
     }
-    // Only update if something changed
-    if (prevDelay != m_currentDelayMs || prevImage != m_image || prevStatus != m_statusText) {
+    // Only update if something changed; the delay is only visible in the debug overlay
+    bool imageChanged = prevImageKey != m_image.cacheKey();
+    if (prevStatus != m_statusText || (m_debugMode && prevDelay != m_currentDelayMs) ||
+        (imageChanged && (!isDelta || dirtyRegion.isEmpty()))) {
         if (m_debugPrint) qDebug() << "[DEBUG] Frame update: delay=" << m_currentDelayMs << ", status=" << m_statusText;
-        update(); // Trigger a repaint
-        repaint(); // Force immediate repaint - try this if update() isn't working
+        schedulePresent(rect());
+    } else if (!dirtyRegion.isEmpty()) {
+        // Only the changed tiles need to be repainted
+        schedulePresent(dirtyRegion);
     }
+    // Decoded or dropped, the frame no longer occupies the server's window. Frames sent before the
+    // server applied the current window were not counted against it.
+    if (creditsActive() && m_serverCreditEpoch == m_creditEpoch)
+        returnCredit();
+    CpuGovernor::instance().addUsage(this, cpuTimer.nsecsElapsed());
 }
 
 /**
@@ -318,21 +935,44 @@ void MyWidget::checkConnectionStatus()
     if (m_inGedi) return; // Do not connect in editor
     bool needUpdate = false;
     if (m_webSocket->state() != QAbstractSocket::ConnectedState) {
-        if (m_statusText != statusMsg.noConnection || !m_image.isNull()) {
+        if (m_statusText != statusMsg.noConnection || (!m_image.isNull() && !m_imageIsStale)) {
             m_statusText = statusMsg.noConnection;
-            m_image = QImage();
+            if (!m_imageIsStale)
+                m_image = QImage();
             needUpdate = true;
         }
+        for (int i = 0; i < m_mosaic.count(); ++i)
+            needUpdate |= setMosaicTileStatus(m_mosaic.tile(i), statusMsg.noConnection);
         if (!m_webSocketUrl.isEmpty()) {
             m_webSocket->open(QUrl(m_webSocketUrl)); // Attempt to reconnect
         }
+    } else if (mosaicActive()) {
+        // Each tile freezes on its own
+        qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
+        for (int i = 0; i < m_mosaic.count(); ++i) {
+            MosaicTile &tile = m_mosaic.tile(i);
+            if (tile.lastFrameTimestamp > 0 && currentTime - tile.lastFrameTimestamp > kFrozenAfterMs &&
+                setMosaicTileStatus(tile, statusMsg.frozen)) {
+                update(m_mosaic.cellRect(i, rect()));
+            }
+        }
     } else {
         // Check if we are receiving frames
         qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-        if (m_lastFrameTimestamp > 0 && (currentTime - m_lastFrameTimestamp > 500)) { // No frame in 5s
-            if (m_statusText != statusMsg.frozen || !m_image.isNull()) {
+        if (m_lastFrameTimestamp > 0 && (currentTime - m_lastFrameTimestamp > kFrozenAfterMs)) {
+            if (m_transport == Auto && m_activeTransport == UDP && m_statusText != statusMsg.frozen &&
+                ++m_autoFreezeCount >= kMaxAutoFreezes) {
+                // UDP keeps failing on this path; the next probe decides whether to come back
+                fallbackToWebSocket("repeated freezes");
+            }
+            if (creditsActive() && m_statusText != statusMsg.frozen) {
+                // A lost credit would stall the stream for good; grant a fresh window once per freeze
+                sendCredits(m_flowControlCredits, true);
+            }
+            if (m_statusText != statusMsg.frozen || (!m_image.isNull() && !m_imageIsStale)) {
                 m_statusText = statusMsg.frozen;
-                m_image = QImage(); // Clear image
+                if (!m_imageIsStale)
+                    m_image = QImage(); // Clear image
                 needUpdate = true;
             }
         }
@@ -347,29 +987,38 @@ void MyWidget::checkConnectionStatus()
 /**
  * \brief MyWidget::paintEvent
  * Handles all custom painting for the widget, including the image, status text, and debug overlay.
- * \param event The paint event (QPaintEvent*), typically not used directly in this implementation.
+ * \param event The paint event (QPaintEvent*); in mosaic mode only the tiles in its region are drawn.
  */
-void MyWidget::paintEvent(QPaintEvent *)
+void MyWidget::paintEvent(QPaintEvent *event)
 {
   if (m_debugPrint) qDebug() << "[DEBUG] paintEvent called. Image null?" << m_image.isNull() << "Status text:" << m_statusText;
+  QElapsedTimer cpuTimer; // Time on the GUI thread, accounted to the CPU governor
+  cpuTimer.start();
   QPainter painter(this);
   painter.setRenderHint(QPainter::Antialiasing);
 
-  if (!m_image.isNull()) {
+  if (mosaicActive()) {
+        paintMosaic(painter, event->region());
+  } else if (!m_image.isNull()) {
         if (m_debugPrint) qDebug() << "[DEBUG] Drawing image, size:" << m_image.size();
-        // Calculate scaled size while preserving aspect ratio
-        QSize widgetSize = rect().size();
-        QSize imageSize = m_image.size();
-        QSize scaledSize = imageSize.scaled(widgetSize, Qt::KeepAspectRatio);
-        // Center the image in the widget
-        int x = (widgetSize.width() - scaledSize.width()) / 2;
-        int y = (widgetSize.height() - scaledSize.height()) / 2;
-        QRect targetRect(x, y, scaledSize.width(), scaledSize.height());
+        // Target rect preserves the aspect ratio of the shown region and is centered in the widget
+        QRect targetRect = imageTargetRect();
+        QRectF sourceRect = imageSourceRect();
         // Fill background with black
         painter.fillRect(rect(), Qt::black);
         // Draw the scaled image
-        painter.drawImage(targetRect, m_image.scaled(scaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        
+        painter.drawImage(targetRect.topLeft(), scaledFrame(targetRect, sourceRect));
+
+        if (m_imageIsStale) {
+            // Dim the cached frame and say so, it must not be mistaken for live video
+            painter.fillRect(targetRect, QColor(0, 0, 0, 96));
+            QString staleText = statusMsg.cachedFrame.arg(m_staleServerTimestamp > 0
+                ? QDateTime::fromMSecsSinceEpoch(m_staleServerTimestamp).toString("yyyy-MM-dd HH:mm:ss")
+                : QString("N/A"));
+            if (!m_statusText.isEmpty())
+                staleText += "\n" + m_statusText;
+            drawStatusBox(painter, staleText, rect());
+        }
   } else {
         if (m_debugPrint) qDebug() << "[DEBUG] Drawing green background with status:" << m_statusText;
         // Explicitly draw green background
@@ -377,28 +1026,7 @@ void MyWidget::paintEvent(QPaintEvent *)
 
         // Draw status text
         if (!m_statusText.isEmpty()) {
-            painter.setPen(Qt::black); // Will be overridden for text, but good for default
-            painter.setFont(QFont("Roboto", 12, QFont::Bold));
-            QRect textRect = rect().adjusted(10, 10, -10, -10); // Area for text
-
-            // Calculate bounding rect for the text itself to size the background
-            QRect actualTextBoundingRect = painter.boundingRect(textRect, Qt::AlignCenter | Qt::TextWordWrap, m_statusText);
-
-            // Create a slightly larger rect for the background, centered with the text
-            QRectF backgroundRect = actualTextBoundingRect;
-            backgroundRect.adjust(-10, -5, 10, 5); // Add padding
-            // Center the background rect within the widget, similar to how text is centered
-            backgroundRect.moveCenter(rect().center());
-
-
-            // Background for text
-            QBrush textBgBrush(QColor(0, 0, 0, 128)); // Grey, translucent
-            painter.setBrush(textBgBrush);
-            painter.setPen(Qt::NoPen); // No border for the background
-            painter.drawRoundedRect(backgroundRect, 10, 10); // Rounded corners
-
-            painter.setPen(Qt::white); // Text color
-            painter.drawText(textRect, Qt::AlignCenter | Qt::TextWordWrap, m_statusText);
+            drawStatusBox(painter, m_statusText, rect());
         }
   }
 
@@ -421,6 +1049,46 @@ void MyWidget::paintEvent(QPaintEvent *)
                               .arg(currentTimeStr)
                               .arg(serverIp)
                               .arg(m_rtspStreamUrl.isEmpty() ? "N/A" : m_rtspStreamUrl);
+      if (mosaicActive())
+          debugText += QString("\nMosaic: %1 streams in %2 x %3").arg(m_mosaic.count()).arg(m_mosaic.columns()).arg(m_mosaic.rows());
+      debugText += QString("\nDuplicates suppressed: %1").arg(m_duplicateFrames);
+      if (m_transport == Auto)
+          debugText += QString("\nTransport: auto, using %1%2").arg(transportName(m_activeTransport))
+                           .arg(m_probeResult.isEmpty() ? QString() : " (" + m_probeResult + ")");
+      else if (m_activeTransport != m_transport)
+          debugText += QString("\nTransport: %1 (fallback from %2)").arg(transportName(m_activeTransport), transportName(m_transport));
+      else if (m_activeTransport == SharedMemory && m_shmReader)
+          debugText += QString("\nTransport: shm, frame %1, %2 overwritten unread").arg(m_shmReader->sequence()).arg(m_shmReader->skippedFrames());
+      if (m_fec.stats().completeFrames > 0 || m_fec.stats().unrecoverableFrames > 0) {
+          debugText += QString("\nFEC: %1 fragments recovered, %2 frames lost")
+                           .arg(m_fec.stats().recoveredFragments)
+                           .arg(m_fec.stats().unrecoverableFrames);
+      }
+      if (!m_warmStreams.isEmpty())
+          debugText += QString("\nStandby: %1 warm, %2 promotions").arg(m_warmStreams.size()).arg(m_standbyPromotions);
+      if (m_incrementalDecodes > 0) {
+          // Decode time hidden behind the transfer of the remaining fragments
+          debugText += QString("\nIncremental decode: %1 of %2 ms overlapped with transfer (%3 frames)")
+                           .arg(qMax(0.0, m_decodeNsecsAvg - m_decodeTailNsecsAvg) / 1e6, 0, 'f', 1)
+                           .arg(m_decodeNsecsAvg / 1e6, 0, 'f', 1)
+                           .arg(m_incrementalDecodes);
+      }
+      if (creditsActive())
+          debugText += QString("\nCredits: window %1, %2 to return%3").arg(m_flowControlCredits).arg(m_pendingCredits)
+                           .arg(m_serverCreditEpoch != m_creditEpoch ? " (window pending)" : "");
+      CpuGovernor &governor = CpuGovernor::instance();
+      debugText += QString("\nCPU: %1 ms/s (all widgets %2 of %3 ms/s), level %4, skipped %5")
+                       .arg(governor.clientUsage(this), 0, 'f', 1)
+                       .arg(governor.totalUsage(), 0, 'f', 1)
+                       .arg(governor.budgetPercent() * 10)
+                       .arg(m_governorLevel)
+                       .arg(m_governorSkippedFrames);
+      if (clientUndistortionActive())
+          debugText += QString("\nUndistortion: client-side, alpha %1").arg(undistortionAlpha(), 0, 'f', 1);
+      if (m_zoom > 1.0 || m_activeRoi != QRectF(0, 0, 1, 1)) {
+          debugText += QString("\nZoom: x%1%2").arg(m_zoom, 0, 'f', 1)
+                           .arg(requestedRoi() != m_activeRoi ? " (client-side, region pending)" : "");
+      }
       if (m_overLatencyCutoff) {
           debugText.prepend("[!] Latency above cutoff!\n");
       }
@@ -472,50 +1140,12 @@ void MyWidget::paintEvent(QPaintEvent *)
       painter.setPen(Qt::white); // Text color for debug
       // Draw the text within the debugTextDrawRect, it will use this rect's width for wrapping.
       painter.drawText(debugTextDrawRect, Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap, debugText);
-  } else if (!m_streamName.isEmpty()) {
-      // Draw stream name box in selected corner
-      painter.setFont(QFont("Roboto", 10));
-      QFontMetrics fm = painter.fontMetrics();
-      int linePadding = 5;
-      int boxPadding = 5;
-      QString nameText = m_streamName;
-      QRect nameTextRect = fm.boundingRect(nameText);
-      int actualBoxWidth = nameTextRect.width() + 2 * linePadding;
-      int actualBoxHeight = nameTextRect.height() + 2 * linePadding;
-      int x = 0, y = 0;
-      switch (m_streamNameBoxPosition) {
-        case TopLeft:
-            x = boxPadding;
-            y = boxPadding;
-            break;
-        case TopRight:
-            x = width() - actualBoxWidth - boxPadding;
-            y = boxPadding;
-            break;
-        case BottomRight:
-            x = width() - actualBoxWidth - boxPadding;
-            y = height() - actualBoxHeight - boxPadding;
-            break;
-        case BottomLeft:
-            x = boxPadding;
-            y = height() - actualBoxHeight - boxPadding;
-            break;
-        default:
-            x = boxPadding;
-            y = boxPadding;
-      }
-      QRectF nameBoxRect(x, y, actualBoxWidth, actualBoxHeight);
-      QBrush nameBoxBrush(QColor(0, 0, 0, 128));
-      painter.setBrush(nameBoxBrush);
-      painter.setPen(Qt::NoPen);
-      painter.drawRoundedRect(nameBoxRect, 5, 5);
-      QRectF nameTextDrawRect = nameBoxRect.adjusted(linePadding, linePadding, -linePadding, -linePadding);
-      painter.setPen(Qt::white);
-      painter.drawText(nameTextDrawRect, Qt::AlignLeft | Qt::AlignVCenter, nameText);
+  } else if (!m_streamName.isEmpty() && !mosaicActive()) {
+      drawNameBox(painter, m_streamName, rect());
   }
 
   // Draw undistortion button if available
-  if (m_undistortionAvailable) {
+  if (m_undistortionAvailable && !mosaicActive()) {
       int boxPadding = 5;
       int iconSize = 32; // Larger icon size for better touch accessibility
 
@@ -555,111 +1185,1202 @@ void MyWidget::paintEvent(QPaintEvent *)
           painter.drawText(m_undistortButtonRect, Qt::AlignCenter, "!");
       }
   }
+  CpuGovernor::instance().addUsage(this, cpuTimer.nsecsElapsed());
 }
 
-void MyWidget::onTextMessageReceived(const QString &message)
+/**
+ * \brief MyWidget::scaledFrame
+ * Returns m_image scaled for display, rebuilding the cache only when the image, the target
+ * rect or the shown region changed. Tile updates patch the cache in place.
+ * \param targetRect Where the frame is drawn in widget coordinates.
+ * \param sourceRect The part of m_image to show, in image pixels.
+ * \return The scaled frame, to be drawn at targetRect.topLeft().
+ */
+const QImage &MyWidget::scaledFrame(const QRect &targetRect, const QRectF &sourceRect)
 {
-    if (m_debugPrint) qDebug() << "[DEBUG] onTextMessageReceived called with:" << message;
-    QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8());
-    if (!doc.isObject()) return;
-
-    QJsonObject obj = doc.object();
-    QString type = obj["type"].toString();
-
-    if (type == "undistortion_info") {
-        m_undistortionAvailable = obj["available"].toBool();
-        m_undistortionEnabled = obj["enabled"].toBool();
-        m_undistortionMode = obj["mode"].toInt(0); // Default to 0 if not present
-        if (m_debugPrint) qDebug() << "[DEBUG] Undistortion available:" << m_undistortionAvailable << "enabled:" << m_undistortionEnabled << "mode:" << m_undistortionMode;
-        update();
-    } else if (type == "undistortion_state") {
-        m_undistortionEnabled = obj["enabled"].toBool();
-        m_undistortionMode = obj["mode"].toInt(0); // Default to 0 if not present
-        if (m_debugPrint) qDebug() << "[DEBUG] Undistortion state updated to enabled:" << m_undistortionEnabled << "mode:" << m_undistortionMode;
-        update();
+    // Over the CPU budget, nearest-neighbour scaling is used instead of the smooth filter
+    bool fast = m_governorLevel >= CpuGovernor::FastScaling;
+    int undistortMode = clientUndistortionActive() ? m_undistortionMode : 0;
+    if (!m_scaledFrame.isNull() && m_scaledFrameKey == m_image.cacheKey() &&
+        m_scaledTarget == targetRect && m_scaledSource == sourceRect && m_scaledFast == fast &&
+        m_scaledUndistortMode == undistortMode)
+        return m_scaledFrame;
+
+    if (undistortMode != 0) {
+        // Undistort, crop and scale in one lookup per output pixel; the remap table is only
+        // rebuilt when the size, the region or the mode changes
+        if (m_scaledFrame.size() != targetRect.size() || m_scaledFrame.format() != QImage::Format_RGB32)
+            m_scaledFrame = QImage(targetRect.size(), QImage::Format_RGB32);
+        m_lensRemap.remap(m_image, m_activeRoi, m_scaledFrame, requestedRoi(), undistortionAlpha(), fast);
+    } else if (sourceRect.toRect() == m_image.rect()) {
+        m_scaledFrame = m_image.scaled(targetRect.size(), Qt::KeepAspectRatio,
+                                       fast ? Qt::FastTransformation : Qt::SmoothTransformation);
+    } else {
+        // The requested region differs from what the server sends (e.g. a new region is pending):
+        // crop and scale client-side until frames of the new region arrive
+        m_scaledFrame = QImage(targetRect.size(), QImage::Format_RGB32);
+        m_scaledFrame.fill(Qt::black);
+        QPainter painter(&m_scaledFrame);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, !fast);
+        painter.drawImage(QRectF(m_scaledFrame.rect()), m_image, sourceRect);
     }
+    m_scaledFast = fast;
+    m_scaledUndistortMode = undistortMode;
+    m_scaledFrameKey = m_image.cacheKey();
+    m_scaledTarget = targetRect;
+    m_scaledSource = sourceRect;
+    return m_scaledFrame;
 }
 
-void MyWidget::mousePressEvent(QMouseEvent *event)
+/**
+ * \brief MyWidget::applyTileUpdate
+ * Patches the tiles of a delta frame into m_image and, if it is current, into the scaled frame cache.
+ * \param data Delta frame payload: quint16 tile count, then per tile quint16 x, quint16 y,
+ * quint32 size and the tile's JPEG data (big endian).
+ * \param dirtyRegion Receives the widget area that changed; empty if the whole frame must be repainted.
+ * \return False if the payload is malformed or a tile cannot be decoded.
+ */
+bool MyWidget::applyTileUpdate(QByteArrayView data, QRegion &dirtyRegion)
 {
-    if (m_debugPrint) qDebug() << "[DEBUG] Mouse press at" << event->pos() << "button rect:" << m_undistortButtonRect;
-    if (m_undistortionAvailable && m_undistortButtonRect.contains(event->pos())) {
-        if (m_debugPrint) qDebug() << "[DEBUG] Undistort button clicked via mouse";
-        if (m_webSocket->state() == QAbstractSocket::ConnectedState) {
-            QJsonObject message;
-            message["type"] = "control";
-            message["command"] = "toggle_undistortion";
-            m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    QRect targetRect = imageTargetRect();
+    QRectF sourceRect = imageSourceRect();
+    bool cacheCurrent = !m_scaledFrame.isNull() && m_scaledFrameKey == m_image.cacheKey() &&
+                        m_scaledTarget == targetRect && m_scaledSource == sourceRect &&
+                        m_scaledFast == (m_governorLevel >= CpuGovernor::FastScaling) &&
+                        m_scaledUndistortMode == 0; // A remapped frame is rebuilt as a whole
+
+    const uchar *ptr = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *end = ptr + data.size();
+    if (end - ptr < 2)
+        return false;
+    quint16 tileCount = qFromBigEndian<quint16>(ptr);
+    ptr += 2;
+    if (tileCount == 0)
+        return true; // Nothing moved; leave m_image untouched so nothing is repainted
+
+    QList<QRect> tileRects;
+    QPainter painter(&m_image);
+    for (int i = 0; i < tileCount; ++i) {
+        if (end - ptr < 8)
+            return false;
+        int x = qFromBigEndian<quint16>(ptr);
+        int y = qFromBigEndian<quint16>(ptr + 2);
+        quint32 size = qFromBigEndian<quint32>(ptr + 4);
+        ptr += 8;
+        if (quint32(end - ptr) < size)
+            return false;
+        QImage tile;
+        if (!tile.loadFromData(ptr, int(size), "JPEG"))
+            return false;
+        ptr += size;
+        QRect tileRect(x, y, tile.width(), tile.height());
+        if (!m_image.rect().contains(tileRect)) {
+            // The tiles belong to a frame of another size, e.g. after a region change
+            painter.end();
+            requestKeyframe();
+            return true;
         }
-        event->accept();
-    } else {
-        event->ignore();
+        painter.drawImage(tileRect.topLeft(), tile);
+        tileRects.append(tileRect);
+    }
+    painter.end();
+
+    if (!cacheCurrent || sourceRect.isEmpty())
+        return true; // Rebuilt on the next paint, dirtyRegion stays empty for a full repaint
+
+    // Rescale just the changed tiles into the cache, with a one pixel margin for the filter
+    qreal sx = m_scaledFrame.width() / sourceRect.width();
+    qreal sy = m_scaledFrame.height() / sourceRect.height();
+    QPainter cachePainter(&m_scaledFrame);
+    cachePainter.setRenderHint(QPainter::SmoothPixmapTransform, !m_scaledFast);
+    for (const QRect &tileRect : tileRects) {
+        QRectF mapped((tileRect.x() - sourceRect.x()) * sx, (tileRect.y() - sourceRect.y()) * sy,
+                      tileRect.width() * sx, tileRect.height() * sy);
+        QRect dirty = mapped.toAlignedRect().adjusted(-1, -1, 1, 1) & m_scaledFrame.rect();
+        if (dirty.isEmpty())
+            continue; // Tile is outside the shown region
+        QRectF source(sourceRect.x() + dirty.x() / sx, sourceRect.y() + dirty.y() / sy,
+                      dirty.width() / sx, dirty.height() / sy);
+        cachePainter.drawImage(QRectF(dirty), m_image, source);
+        dirtyRegion += dirty.translated(targetRect.topLeft());
     }
+    cachePainter.end();
+    m_scaledFrameKey = m_image.cacheKey();
+    return true;
 }
 
-bool MyWidget::event(QEvent *event)
+/**
+ * \brief MyWidget::requestKeyframe
+ * Asks the server for a complete frame, e.g. when tiles arrive without a matching base frame.
+ */
+void MyWidget::requestKeyframe()
 {
-    switch (event->type()) {
-    case QEvent::TouchBegin:
-    case QEvent::TouchUpdate:
-    case QEvent::TouchEnd: {
-        QTouchEvent *touchEvent = static_cast<QTouchEvent*>(event);
-        if (touchEvent->points().size() == 1) {
-            const QTouchEvent::TouchPoint &touchPoint = touchEvent->points().first();
-            QPointF posF = touchPoint.position();
-            QPoint pos = posF.toPoint();
-            
-            if (m_debugPrint) qDebug() << "[DEBUG] Touch event at" << pos << "button rect:" << m_undistortButtonRect;
-            
-            if (event->type() == QEvent::TouchEnd && 
-                m_undistortionAvailable && 
-                m_undistortButtonRect.contains(pos)) {
-                
-                if (m_debugPrint) qDebug() << "[DEBUG] Undistort button touched";
-                if (m_webSocket->state() == QAbstractSocket::ConnectedState) {
-                    QJsonObject message;
-                    message["type"] = "control";
-                    message["command"] = "toggle_undistortion";
-                    m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
-                }
-                event->accept();
-                return true;
-            }
-        }
-        // Accept all touch events to prevent them from being converted to mouse events
-        event->accept();
-        return true;
-    }
-    default:
-        break;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (now - m_lastKeyframeRequest < kKeyframeRequestMs || m_webSocket->state() != QAbstractSocket::ConnectedState)
+        return;
+    m_lastKeyframeRequest = now;
+    if (m_debugPrint) qDebug() << "[DEBUG] Requesting keyframe";
+    QJsonObject message;
+    message["type"] = "control";
+    message["command"] = "request_keyframe";
+    m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+/**
+ * \brief MyWidget::creditsActive
+ * \return True if frames arrive over the WebSocket under credit-based flow control.
+ */
+bool MyWidget::creditsActive() const
+{
+    return m_flowControlCredits > 0 && m_activeTransport == WebSocket && !mosaicActive();
+}
+
+/**
+ * \brief MyWidget::returnCredit
+ * Credits a handled frame back to the server. Credits are batched to half the window, so at
+ * larger windows not every frame costs a control message. Only frames of the current credit
+ * epoch are credited, see onTextMessageReceived.
+ */
+void MyWidget::returnCredit()
+{
+    m_pendingCredits++;
+    if (m_pendingCredits >= qMax(1, m_flowControlCredits / 2)) {
+        sendCredits(m_pendingCredits, false);
+        m_pendingCredits = 0;
     }
-    
-    return QWidget::event(event);
 }
 
-// Implementation for setTransport, setUdpPort
-void MyWidget::setTransport(TransportProtocol protocol) {
-    if (m_transport == protocol)
+/**
+ * \brief MyWidget::sendCredits
+ * Sends a credit control message to the server.
+ * \param credits Number of frames the server may send in addition, or the whole window on reset.
+ * \param reset True to replace the server's credit count instead of adding to it.
+ */
+void MyWidget::sendCredits(int credits, bool reset)
+{
+    if (m_webSocket->state() != QAbstractSocket::ConnectedState)
         return;
-    m_transport = protocol;
-    if (m_debugPrint) qDebug() << "[DEBUG] setTransport called with" << (m_transport == UDP ? "UDP" : "WebSocket");
-    if (m_transport == UDP) {
-        setupUdpSocket();
+    QJsonObject message;
+    message["type"] = "control";
+    message["command"] = "credit";
+    if (reset) {
+        m_creditEpoch++;
+        message["reset"] = true;
+        m_pendingCredits = 0;
+        m_creditResets++;
+        if (m_debugPrint) qDebug() << "[DEBUG] Resetting flow control window to" << credits;
     } else {
-        closeUdpSocket();
+        m_creditsReturned += credits;
     }
+    message["credits"] = credits;
+    message["credit_epoch"] = qint64(m_creditEpoch); // The server ignores credits of an earlier epoch
+    m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
 }
-void MyWidget::setUdpPort(int port) {
-    if (m_udpPort == port)
-        return;
+
+/**
+ * \brief MyWidget::onGovernorLevelChanged
+ * Applies a degradation level decided by the CPU governor to this widget.
+ * \param client The widget whose level changed; other widgets' changes are ignored.
+ * \param level The new CpuGovernor::Level.
+ */
+void MyWidget::onGovernorLevelChanged(QObject *client, int level)
+{
+    if (client != this || level == m_governorLevel)
+        return;
+    if (m_debugPrint) qDebug() << "[DEBUG] CPU governor level changed from" << m_governorLevel << "to" << level;
+    bool resolutionChanged = (level >= CpuGovernor::ReducedResolution) != (m_governorLevel >= CpuGovernor::ReducedResolution);
+    m_governorLevel = level;
+    if (resolutionChanged)
+        sendResolutionScale();
+    if (m_skippedTiles && level < CpuGovernor::SkipFrames) {
+        // The frame misses the tiles of the skipped deltas until it is replaced
+        m_skippedTiles = false;
+        requestKeyframe();
+    }
+    update(); // Rescale with the filter of the new level
+}
+
+/**
+ * \brief MyWidget::sendResolutionScale
+ * Tells the server which fraction of the full resolution to stream, as decided by the CPU governor.
+ */
+void MyWidget::sendResolutionScale()
+{
+    if (m_webSocket->state() != QAbstractSocket::ConnectedState || !hasStream())
+        return;
+    if (mosaicActive()) {
+        sendSetStream(); // The scale is part of the requested cell size
+        return;
+    }
+    QJsonObject message;
+    message["type"] = "control";
+    message["command"] = "set_resolution_scale";
+    message["scale"] = m_governorLevel >= CpuGovernor::ReducedResolution ? kReducedResolutionScale : 1.0;
+    m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+/**
+ * \brief MyWidget::schedulePresent
+ * Queues an area for repainting. Areas queued within one presentation interval are merged
+ * into a single asynchronous update, so fast sources cost at most one paint per interval.
+ * \param region The widget area to repaint.
+ */
+void MyWidget::schedulePresent(const QRegion &region)
+{
+    m_pendingPresent += region;
+    if (m_presentTimer.isActive())
+        return;
+    qint64 sinceLast = m_lastPresent.isValid() ? m_lastPresent.elapsed() : presentIntervalMs();
+    m_presentTimer.start(int(qMax<qint64>(0, presentIntervalMs() - sinceLast)));
+}
+
+/**
+ * \brief MyWidget::present
+ * Hands the merged pending area to Qt for repainting.
+ */
+void MyWidget::present()
+{
+    if (m_pendingPresent.isEmpty())
+        return;
+    update(m_pendingPresent);
+    m_pendingPresent = QRegion();
+    m_lastPresent.start();
+}
+
+/**
+ * \brief MyWidget::presentIntervalMs
+ * Returns the minimum time between two presented frames: one display refresh, or 1/maxFps if longer.
+ * \return The interval in milliseconds.
+ */
+int MyWidget::presentIntervalMs() const
+{
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    int interval = refreshRate > 0 ? int(1000.0 / refreshRate) : 16;
+    if (m_maxFps > 0)
+        interval = qMax(interval, 1000 / m_maxFps);
+    return interval;
+}
+
+/**
+ * \brief MyWidget::getStatistics
+ * Collects runtime statistics of the widget, e.g. for diagnostics from a control script.
+ * \return Mapping of statistic names to values.
+ */
+QVariantMap MyWidget::getStatistics() const
+{
+    CpuGovernor &governor = CpuGovernor::instance();
+    QVariantMap stats;
+    stats["delayMs"] = m_currentDelayMs;
+    stats["transport"] = transportName(m_transport);
+    stats["activeTransport"] = transportName(m_activeTransport);
+    stats["transportProbe"] = m_probeResult;
+    stats["warmStreams"] = m_warmStreams.size();
+    stats["standbyPromotions"] = m_standbyPromotions;
+    stats["mosaicTiles"] = m_mosaic.count();
+    stats["incrementalDecodes"] = m_incrementalDecodes;
+    stats["incrementalDecodeMs"] = m_decodeNsecsAvg / 1e6;
+    stats["incrementalDecodeTailMs"] = m_decodeTailNsecsAvg / 1e6;
+    stats["shmSkippedFrames"] = m_shmReader ? m_shmReader->skippedFrames() : 0;
+    stats["cpuMsPerSecond"] = governor.clientUsage(const_cast<MyWidget *>(this));
+    stats["processCpuMsPerSecond"] = governor.totalUsage();
+    stats["cpuBudgetPercent"] = governor.budgetPercent();
+    stats["governorLevel"] = m_governorLevel;
+    stats["governorSkippedFrames"] = m_governorSkippedFrames;
+    stats["duplicateFrames"] = m_duplicateFrames;
+    stats["flowControlCredits"] = creditsActive() ? m_flowControlCredits : 0;
+    stats["creditsReturned"] = m_creditsReturned;
+    stats["creditResets"] = m_creditResets;
+    stats["fecCompleteFrames"] = m_fec.stats().completeFrames;
+    stats["fecRecoveredFragments"] = m_fec.stats().recoveredFragments;
+    stats["fecUnrecoverableFrames"] = m_fec.stats().unrecoverableFrames;
+    return stats;
+}
+
+/**
+ * \brief MyWidget::saveSnapshot
+ * Writes the current live frame as received from the server, without overlays, client-side zoom
+ * or undistortion. If a JPEG is requested and the compressed frame is at hand it is written as
+ * received, otherwise the frame is encoded. Both happen on the global thread pool; the result is
+ * reported with snapshotSaved(). The server timestamp is stored as JPEG comment or image text,
+ * together with the server-side region and resolution scale when the frame is not the whole
+ * camera picture at full resolution.
+ * \param path Target file; an existing file is replaced atomically.
+ * \param format Image format such as "jpg" or "png"; empty to derive it from the file suffix.
+ * \param quality Encoder quality 0..100, -1 for the default; not used when the JPEG is written as received.
+ * \return False if there is no live frame (none, or only the cached one) or the format is not
+ * supported; snapshotSaved() is not emitted then.
+ */
+bool MyWidget::saveSnapshot(const QString &path, const QString &format, int quality)
+{
+    QByteArray imageFormat = (format.isEmpty() ? QFileInfo(path).suffix() : format).toLower().toLatin1();
+    if (imageFormat == "jpeg")
+        imageFormat = "jpg";
+    if (m_image.isNull() || path.isEmpty() || !QImageWriter::supportedImageFormats().contains(imageFormat)) {
+        if (m_debugPrint) qDebug() << "[DEBUG] saveSnapshot: nothing to save or unsupported format" << imageFormat;
+        return false;
+    }
+    if (m_imageIsStale) {
+        // The cached frame is from an earlier session; it must not be saved as a live picture
+        if (m_debugPrint) qDebug() << "[DEBUG] saveSnapshot: only the cached frame is available";
+        return false;
+    }
+    if (m_debugPrint) qDebug() << "[DEBUG] saveSnapshot to" << path << "format:" << imageFormat << "quality:" << quality;
+
+    qint64 serverTimestamp = m_lastPayloadTimestamp;
+    QString timestampText = QDateTime::fromMSecsSinceEpoch(serverTimestamp, QTimeZone::utc()).toString(Qt::ISODateWithMs);
+    // Frames cropped or scaled down by the server say so, a full frame carries only the timestamp
+    QString regionText;
+    if (m_activeRoi != QRectF(0, 0, 1, 1)) {
+        regionText = QString("%1,%2,%3,%4").arg(m_activeRoi.x(), 0, 'f', 4).arg(m_activeRoi.y(), 0, 'f', 4)
+                         .arg(m_activeRoi.width(), 0, 'f', 4).arg(m_activeRoi.height(), 0, 'f', 4);
+    }
+    QString scaleText;
+    if (m_governorLevel >= CpuGovernor::ReducedResolution)
+        scaleText = QString::number(kReducedResolutionScale);
+    // Implicitly shared copies, nothing is copied on the GUI thread
+    QImage image = m_image;
+    QByteArray jpeg = imageFormat == "jpg" ? m_lastPayload : QByteArray();
+    QString stream = m_rtspStreamUrl;
+    QPointer<MyWidget> guard(this);
+    QThreadPool::globalInstance()->start([path, imageFormat, quality, timestampText, regionText, scaleText, image, jpeg,
+                                          stream, guard]() {
+        QString error;
+        if (!jpeg.isEmpty()) {
+            QSaveFile file(path);
+            QString commentText = QString("ServerTimestamp=%1").arg(timestampText);
+            if (!regionText.isEmpty())
+                commentText += QString("; Region=%1").arg(regionText);
+            if (!scaleText.isEmpty())
+                commentText += QString("; Scale=%1").arg(scaleText);
+            QByteArray comment = commentText.toUtf8();
+            if (!file.open(QIODevice::WriteOnly) || file.write(insertJpegComment(jpeg, comment)) < 0 || !file.commit())
+                error = file.errorString();
+        } else {
+            QImageWriter writer(path, imageFormat);
+            writer.setQuality(quality);
+            writer.setText("ServerTimestamp", timestampText);
+            writer.setText("Source", stream);
+            if (!regionText.isEmpty())
+                writer.setText("Region", regionText); // x,y,width,height relative to the camera frame
+            if (!scaleText.isEmpty())
+                writer.setText("Scale", scaleText);
+            if (!writer.write(image))
+                error = writer.errorString();
+        }
+        // Back to the GUI thread; the widget may be gone by then
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, path, error]() {
+            if (guard)
+                emit guard->snapshotSaved(path, error.isEmpty(), error);
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+/**
+ * \brief MyWidget::drawStatusBox
+ * Draws a status message centered in an area on a translucent rounded background.
+ * \param painter The active painter of the widget.
+ * \param text The message to draw; may contain line breaks.
+ * \param area The widget, or a mosaic cell.
+ */
+void MyWidget::drawStatusBox(QPainter &painter, const QString &text, const QRect &area)
+{
+    painter.setPen(Qt::black); // Will be overridden for text, but good for default
+    painter.setFont(QFont("Roboto", 12, QFont::Bold));
+    QRect textRect = area.adjusted(10, 10, -10, -10); // Area for text
+
+    // Calculate bounding rect for the text itself to size the background
+    QRect actualTextBoundingRect = painter.boundingRect(textRect, Qt::AlignCenter | Qt::TextWordWrap, text);
+
+    // Create a slightly larger rect for the background, centered with the text
+    QRectF backgroundRect = actualTextBoundingRect;
+    backgroundRect.adjust(-10, -5, 10, 5); // Add padding
+    // Center the background rect within the area, similar to how text is centered
+    backgroundRect.moveCenter(QRectF(area).center());
+
+
+    // Background for text
+    QBrush textBgBrush(QColor(0, 0, 0, 128)); // Grey, translucent
+    painter.setBrush(textBgBrush);
+    painter.setPen(Qt::NoPen); // No border for the background
+    painter.drawRoundedRect(backgroundRect, 10, 10); // Rounded corners
+
+    painter.setPen(Qt::white); // Text color
+    painter.drawText(textRect, Qt::AlignCenter | Qt::TextWordWrap, text);
+}
+
+/**
+ * \brief MyWidget::drawNameBox
+ * Draws a stream name in the corner of an area selected by streamNameBoxPosition.
+ * \param painter The active painter of the widget.
+ * \param text The name to draw.
+ * \param area The widget, or a mosaic cell.
+ */
+void MyWidget::drawNameBox(QPainter &painter, const QString &text, const QRect &area)
+{
+    painter.setFont(QFont("Roboto", 10));
+    QFontMetrics fm = painter.fontMetrics();
+    int linePadding = 5;
+    int boxPadding = 5;
+    QRect nameTextRect = fm.boundingRect(text);
+    int actualBoxWidth = nameTextRect.width() + 2 * linePadding;
+    int actualBoxHeight = nameTextRect.height() + 2 * linePadding;
+    int x = 0, y = 0;
+    switch (m_streamNameBoxPosition) {
+      case TopLeft:
+          x = area.left() + boxPadding;
+          y = area.top() + boxPadding;
+          break;
+      case TopRight:
+          x = area.right() + 1 - actualBoxWidth - boxPadding;
+          y = area.top() + boxPadding;
+          break;
+      case BottomRight:
+          x = area.right() + 1 - actualBoxWidth - boxPadding;
+          y = area.bottom() + 1 - actualBoxHeight - boxPadding;
+          break;
+      case BottomLeft:
+          x = area.left() + boxPadding;
+          y = area.bottom() + 1 - actualBoxHeight - boxPadding;
+          break;
+      default:
+          x = area.left() + boxPadding;
+          y = area.top() + boxPadding;
+    }
+    QRectF nameBoxRect(x, y, actualBoxWidth, actualBoxHeight);
+    QBrush nameBoxBrush(QColor(0, 0, 0, 128));
+    painter.setBrush(nameBoxBrush);
+    painter.setPen(Qt::NoPen);
+    painter.drawRoundedRect(nameBoxRect, 5, 5);
+    QRectF nameTextDrawRect = nameBoxRect.adjusted(linePadding, linePadding, -linePadding, -linePadding);
+    painter.setPen(Qt::white);
+    painter.drawText(nameTextDrawRect, Qt::AlignLeft | Qt::AlignVCenter, text);
+}
+
+/**
+ * \brief MyWidget::paintMosaic
+ * Draws the mosaic tiles in a region; tiles outside it are left alone, so a new frame of one
+ * stream only costs the paint of its cell.
+ * \param painter The active painter of the widget.
+ * \param region The region to repaint.
+ */
+void MyWidget::paintMosaic(QPainter &painter, const QRegion &region)
+{
+    bool fast = m_governorLevel >= CpuGovernor::FastScaling;
+    painter.fillRect(region.boundingRect(), Qt::black); // Gaps between the cells
+    for (int i = 0; i < m_mosaic.count(); ++i) {
+        QRect cell = m_mosaic.cellRect(i, rect());
+        if (!region.intersects(cell))
+            continue;
+        MosaicTile &tile = m_mosaic.tile(i);
+        QString status = tile.status;
+        if (tile.image.isNull()) {
+            painter.fillRect(cell, Qt::darkGreen);
+        } else {
+            QRect target = m_mosaic.imageRect(i, rect());
+            painter.drawImage(target.topLeft(), m_mosaic.scaledImage(i, target.size(), fast));
+            if (tile.imageIsStale) {
+                painter.fillRect(target, QColor(0, 0, 0, 96));
+                QString staleText = statusMsg.cachedFrame.arg(tile.staleServerTimestamp > 0
+                    ? QDateTime::fromMSecsSinceEpoch(tile.staleServerTimestamp).toString("yyyy-MM-dd HH:mm:ss")
+                    : QString("N/A"));
+                status = status.isEmpty() ? staleText : staleText + "\n" + status;
+            }
+        }
+        if (!status.isEmpty())
+            drawStatusBox(painter, status, cell);
+        if (!tile.name.isEmpty())
+            drawNameBox(painter, tile.name, cell);
+    }
+}
+
+/**
+ * \brief MyWidget::showCachedFrame
+ * Replaces the displayed image with the cached last frame of the current stream, marked as stale.
+ * A frame that is not in memory is loaded from disk in the background and shown when it arrives,
+ * unless the stream has changed or delivered a live frame by then.
+ * \return True if a cached frame was in memory and is shown.
+ */
+bool MyWidget::showCachedFrame()
+{
+    if (!m_frameCacheEnabled || m_rtspStreamUrl.isEmpty())
+        return false;
+    qint64 serverTimestamp = 0;
+    QByteArray jpeg = FrameCache::instance().lookup(m_rtspStreamUrl, &serverTimestamp);
+    if (jpeg.isEmpty()) {
+        QString url = m_rtspStreamUrl;
+        qint64 imageKey = m_image.cacheKey(); // Changes once a live frame of the new stream is shown
+        FrameCache::instance().fetch(QStringList() << url, this, [this, url, imageKey](const QByteArray &jpeg, qint64 serverTimestamp) {
+            if (url == m_rtspStreamUrl && (m_image.isNull() || m_image.cacheKey() == imageKey) && !mosaicActive())
+                showCachedJpeg(jpeg, serverTimestamp);
+        });
+        return false;
+    }
+    return showCachedJpeg(jpeg, serverTimestamp);
+}
+
+/**
+ * \brief MyWidget::showCachedJpeg
+ * Decodes a cached frame of the current stream and shows it, marked as stale.
+ * \param jpeg The cached JPEG.
+ * \param serverTimestamp Server timestamp of the cached frame.
+ * \return True if the frame could be decoded.
+ */
+bool MyWidget::showCachedJpeg(const QByteArray &jpeg, qint64 serverTimestamp)
+{
+    QImage cached;
+    if (jpeg.isEmpty() || !cached.loadFromData(jpeg, "JPEG"))
+        return false;
+    if (m_debugPrint) qDebug() << "[DEBUG] Showing cached frame for" << m_rtspStreamUrl << "from" << serverTimestamp;
+    m_image = cached;
+    m_lastPayload = jpeg;
+    m_lastPayloadTimestamp = serverTimestamp;
+    m_imageIsStale = true;
+    m_staleServerTimestamp = serverTimestamp;
+    update();
+    return true;
+}
+
+void MyWidget::onTextMessageReceived(const QString &message)
+{
+    if (m_debugPrint) qDebug() << "[DEBUG] onTextMessageReceived called with:" << message;
+    QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8());
+    if (!doc.isObject()) return;
+
+    QJsonObject obj = doc.object();
+    QString type = obj["type"].toString();
+
+    if (type == "undistortion_info") {
+        m_undistortionAvailable = obj["available"].toBool() || m_lensRemap.hasCalibration();
+        if (m_lensRemap.hasCalibration())
+            return; // The mode is chosen locally
+        m_undistortionEnabled = obj["enabled"].toBool();
+        m_undistortionMode = obj["mode"].toInt(0); // Default to 0 if not present
+        if (m_debugPrint) qDebug() << "[DEBUG] Undistortion available:" << m_undistortionAvailable << "enabled:" << m_undistortionEnabled << "mode:" << m_undistortionMode;
+        update();
+    } else if (type == "undistortion_state") {
+        if (m_lensRemap.hasCalibration())
+            return; // The mode is chosen locally
+        m_undistortionEnabled = obj["enabled"].toBool();
+        m_undistortionMode = obj["mode"].toInt(0); // Default to 0 if not present
+        if (m_debugPrint) qDebug() << "[DEBUG] Undistortion state updated to enabled:" << m_undistortionEnabled << "mode:" << m_undistortionMode;
+        update();
+    } else if (type == "camera_calibration") {
+        // Sent once per stream; from now on the undistortion modes are applied locally
+        LensRemap::Calibration calibration;
+        calibration.imageSize = QSize(obj["width"].toInt(), obj["height"].toInt());
+        calibration.fx = obj["fx"].toDouble();
+        calibration.fy = obj["fy"].toDouble();
+        calibration.cx = obj["cx"].toDouble();
+        calibration.cy = obj["cy"].toDouble();
+        QJsonArray dist = obj["dist"].toArray(); // k1, k2, p1, p2[, k3] as in OpenCV
+        calibration.k1 = dist.at(0).toDouble();
+        calibration.k2 = dist.at(1).toDouble();
+        calibration.p1 = dist.at(2).toDouble();
+        calibration.p2 = dist.at(3).toDouble();
+        calibration.k3 = dist.at(4).toDouble();
+        if (!calibration.isValid()) {
+            if (m_debugPrint) qDebug() << "[DEBUG] Ignoring invalid camera calibration";
+            return;
+        }
+        m_lensRemap.setCalibration(calibration);
+        m_undistortionAvailable = true;
+        if (m_debugPrint) qDebug() << "[DEBUG] Camera calibration received for" << calibration.imageSize << "fx:" << calibration.fx << "fy:" << calibration.fy;
+        update();
+    } else if (type == "credit_epoch") {
+        // The server applied the window of this epoch; the frames after this message count against it
+        m_serverCreditEpoch = quint32(obj["epoch"].toInteger());
+    } else if (type == "roi_state") {
+        // Frames after this message show the given region of the camera frame
+        QRectF roi(obj["x"].toDouble(0), obj["y"].toDouble(0), obj["width"].toDouble(1), obj["height"].toDouble(1));
+        m_activeRoi = (roi.width() > 0 && roi.height() > 0) ? roi : QRectF(0, 0, 1, 1);
+        if (m_debugPrint) qDebug() << "[DEBUG] Server region of interest:" << m_activeRoi;
+        update();
+    } else if (type == "multicast_info") {
+        QHostAddress group(obj["group"].toString());
+        int port = obj["port"].toInt(0);
+        if (m_debugPrint) qDebug() << "[DEBUG] Multicast group assigned:" << group.toString() << "port:" << port;
+        if (m_activeTransport != Multicast)
+            return;
+        m_multicastSetupTimer.stop();
+        if (group.isMulticast() && port > 0 && port <= 65535)
+            joinMulticastGroup(group, static_cast<quint16>(port));
+        else
+            fallbackToWebSocket(obj["error"].toString("no valid multicast group"));
+    } else if (type == "probe_ws") {
+        // WebSocket side of a UDP probe; queued behind the frames like the frames themselves
+        if (m_probeActive && quint32(obj["probe_id"].toInteger()) == m_probeId) {
+            m_probeWsReceived++;
+            m_probeWsDelaySum += QDateTime::currentMSecsSinceEpoch() - obj["timestamp"].toInteger();
+        }
+    } else if (type == "shm_info") {
+        if (m_activeTransport != SharedMemory)
+            return;
+        m_shmSetupTimer.stop();
+        if (!obj["available"].toBool(true))
+            fallbackToWebSocket(obj["error"].toString("shared memory not available"));
+        else
+            openSharedMemory(obj["memory_key"].toString(), obj["semaphore_key"].toString());
+    }
+}
+
+void MyWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (m_debugPrint) qDebug() << "[DEBUG] Mouse press at" << event->pos() << "button rect:" << m_undistortButtonRect;
+    int tile = mosaicActive() && event->button() == Qt::LeftButton ? m_mosaic.tileAt(event->pos(), rect()) : -1;
+    if (tile >= 0) {
+        if (m_debugPrint) qDebug() << "[DEBUG] Mosaic tile" << tile << "clicked";
+        emit mosaicTileClicked(tile, m_mosaic.tile(tile).url);
+        event->accept();
+    } else if (m_undistortionAvailable && m_undistortButtonRect.contains(event->pos())) {
+        if (m_debugPrint) qDebug() << "[DEBUG] Undistort button clicked via mouse";
+        toggleUndistortion();
+        event->accept();
+    } else if (m_zoomEnabled && m_zoom > 1.0 && event->button() == Qt::LeftButton) {
+        // Drag to pan the zoomed view
+        m_panning = true;
+        m_lastPanPos = event->position();
+        event->accept();
+    } else {
+        event->ignore();
+    }
+}
+
+void MyWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_panning) {
+        panBy(event->position() - m_lastPanPos);
+        m_lastPanPos = event->position();
+        event->accept();
+    } else {
+        event->ignore();
+    }
+}
+
+void MyWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (m_panning && event->button() == Qt::LeftButton) {
+        m_panning = false;
+        event->accept();
+    } else {
+        event->ignore();
+    }
+}
+
+void MyWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (mosaicActive()) {
+        event->accept(); // The press already reported the tile; a second report would be a duplicate
+        return;
+    }
+    // Double click outside the undistortion button returns to the whole frame
+    if (m_zoomEnabled && m_zoom > 1.0 && !(m_undistortionAvailable && m_undistortButtonRect.contains(event->pos()))) {
+        resetZoom();
+        event->accept();
+    } else {
+        mousePressEvent(event);
+    }
+}
+
+/**
+ * \brief MyWidget::wheelEvent
+ * Zooms in or out around the cursor position.
+ * \param event The wheel event; one notch changes the zoom by 25 %.
+ */
+void MyWidget::wheelEvent(QWheelEvent *event)
+{
+    if (!m_zoomEnabled || m_image.isNull()) {
+        event->ignore();
+        return;
+    }
+    double steps = event->angleDelta().y() / 120.0;
+    QPointF pos = event->position();
+    zoomAt(pos, widgetToFrame(pos), m_zoom * std::pow(1.25, steps));
+    event->accept();
+}
+
+void MyWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    // The output resolution requested for the region follows the widget size
+    if (m_zoom > 1.0)
+        m_roiTimer.start();
+    if (mosaicActive())
+        m_mosaicLayoutTimer.start(); // So does the cell size of a mosaic
+}
+
+bool MyWidget::event(QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd: {
+        QTouchEvent *touchEvent = static_cast<QTouchEvent*>(event);
+        if (event->type() == QEvent::TouchBegin)
+            m_touchMoved = false;
+
+        if (touchEvent->points().size() >= 2 && m_zoomEnabled && !m_image.isNull()) {
+            // Pinch: zoom by the change of finger distance and keep the frame point under the fingers
+            QPointF p0 = touchEvent->points().at(0).position();
+            QPointF p1 = touchEvent->points().at(1).position();
+            QPointF centroid = (p0 + p1) / 2;
+            qreal distance = QLineF(p0, p1).length();
+            if (m_pinchStartDistance <= 0) {
+                m_pinchStartDistance = qMax<qreal>(distance, 1);
+                m_pinchStartZoom = m_zoom;
+                m_pinchAnchor = widgetToFrame(centroid);
+            } else {
+                zoomAt(centroid, m_pinchAnchor, m_pinchStartZoom * distance / m_pinchStartDistance);
+            }
+            m_touchMoved = true;
+            if (event->type() == QEvent::TouchEnd)
+                m_pinchStartDistance = 0;
+            event->accept();
+            return true;
+        }
+
+        if (touchEvent->points().size() == 1) {
+            const QTouchEvent::TouchPoint &touchPoint = touchEvent->points().first();
+            QPointF posF = touchPoint.position();
+            QPoint pos = posF.toPoint();
+            
+            if (m_debugPrint) qDebug() << "[DEBUG] Touch event at" << pos << "button rect:" << m_undistortButtonRect;
+
+            if (event->type() == QEvent::TouchBegin || m_pinchStartDistance > 0) {
+                // New touch, or one finger left after a pinch: pan from here
+                m_pinchStartDistance = 0;
+                m_lastPanPos = posF;
+            } else if (m_zoomEnabled && m_zoom > 1.0 &&
+                       (m_touchMoved || (posF - m_lastPanPos).manhattanLength() >= kTouchPanThreshold)) {
+                panBy(posF - m_lastPanPos);
+                m_lastPanPos = posF;
+                m_touchMoved = true;
+            }
+            
+            int tile = mosaicActive() ? m_mosaic.tileAt(pos, rect()) : -1;
+            if (event->type() == QEvent::TouchEnd && !m_touchMoved && tile >= 0) {
+                if (m_debugPrint) qDebug() << "[DEBUG] Mosaic tile" << tile << "touched";
+                emit mosaicTileClicked(tile, m_mosaic.tile(tile).url);
+                event->accept();
+                return true;
+            }
+
+            if (event->type() == QEvent::TouchEnd && 
+                !m_touchMoved &&
+                m_undistortionAvailable && 
+                m_undistortButtonRect.contains(pos)) {
+                
+                if (m_debugPrint) qDebug() << "[DEBUG] Undistort button touched";
+                toggleUndistortion();
+                event->accept();
+                return true;
+            }
+        }
+        if (event->type() == QEvent::TouchEnd)
+            m_pinchStartDistance = 0;
+        // Accept all touch events to prevent them from being converted to mouse events
+        event->accept();
+        return true;
+    }
+    default:
+        break;
+    }
+    
+    return QWidget::event(event);
+}
+
+/**
+ * \brief MyWidget::toggleUndistortion
+ * Switches to the next undistortion mode. With a camera calibration from the server this is
+ * done locally and takes effect with the next paint; otherwise the server is asked to switch.
+ */
+void MyWidget::toggleUndistortion()
+{
+    if (m_lensRemap.hasCalibration()) {
+        m_undistortionMode = (m_undistortionMode + 1) % 3;
+        m_undistortionEnabled = m_undistortionMode != 0;
+        if (m_debugPrint) qDebug() << "[DEBUG] Client-side undistortion mode" << m_undistortionMode;
+        // Distorted and undistorted views need different regions from the server
+        if (m_zoom > 1.0 || m_activeRoi != QRectF(0, 0, 1, 1))
+            m_roiTimer.start();
+        update();
+        return;
+    }
+    if (m_webSocket->state() == QAbstractSocket::ConnectedState) {
+        QJsonObject message;
+        message["type"] = "control";
+        message["command"] = "toggle_undistortion";
+        m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    }
+}
+
+/**
+ * \brief MyWidget::clientUndistortionActive
+ * \return True if frames are undistorted by the widget rather than by the server.
+ */
+bool MyWidget::clientUndistortionActive() const
+{
+    return m_lensRemap.hasCalibration() && m_undistortionMode != 0;
+}
+
+/**
+ * \brief MyWidget::undistortionAlpha
+ * Maps the undistortion mode to the free scaling parameter of the new camera matrix.
+ * \return 0.0 for mode 1 (valid pixels only), 0.4 for mode 2.
+ */
+double MyWidget::undistortionAlpha() const
+{
+    return m_undistortionMode == 2 ? 0.4 : 0.0;
+}
+
+/**
+ * \brief MyWidget::requestedRoi
+ * Returns the region of the camera frame the user wants to see.
+ * \return The region, normalized to the full frame (0..1 on both axes).
+ */
+QRectF MyWidget::requestedRoi() const
+{
+    double size = 1.0 / m_zoom;
+    return QRectF(m_zoomCenter.x() - size / 2, m_zoomCenter.y() - size / 2, size, size);
+}
+
+/**
+ * \brief MyWidget::imageSourceRect
+ * Maps the requested region into pixel coordinates of m_image, which shows m_activeRoi.
+ * The result may extend beyond the image while a larger region is still pending.
+ * \return The source rect in image pixels.
+ */
+QRectF MyWidget::imageSourceRect() const
+{
+    QRectF roi = requestedRoi();
+    qreal sx = m_image.width() / m_activeRoi.width();
+    qreal sy = m_image.height() / m_activeRoi.height();
+    return QRectF((roi.x() - m_activeRoi.x()) * sx, (roi.y() - m_activeRoi.y()) * sy,
+                  roi.width() * sx, roi.height() * sy);
+}
+
+/**
+ * \brief MyWidget::imageTargetRect
+ * Computes where the shown region is drawn: scaled to fit, aspect ratio preserved, centered.
+ * \return The target rect in widget coordinates.
+ */
+QRect MyWidget::imageTargetRect() const
+{
+    QSizeF sourceSize = m_image.isNull() ? QSizeF(size()) : imageSourceRect().size();
+    QSize scaledSize = sourceSize.scaled(QSizeF(size()), Qt::KeepAspectRatio).toSize();
+    int x = (width() - scaledSize.width()) / 2;
+    int y = (height() - scaledSize.height()) / 2;
+    return QRect(x, y, scaledSize.width(), scaledSize.height());
+}
+
+/**
+ * \brief MyWidget::widgetToFrame
+ * Maps a widget position to normalized camera frame coordinates of the current view.
+ * \param pos Position in widget coordinates.
+ * \return The position in the frame, normalized to 0..1.
+ */
+QPointF MyWidget::widgetToFrame(const QPointF &pos) const
+{
+    QRectF target = imageTargetRect();
+    QRectF roi = requestedRoi();
+    if (target.isEmpty())
+        return roi.center();
+    return QPointF(roi.x() + (pos.x() - target.x()) / target.width() * roi.width(),
+                   roi.y() + (pos.y() - target.y()) / target.height() * roi.height());
+}
+
+/**
+ * \brief MyWidget::zoomAt
+ * Changes the zoom so that the given frame point ends up under the given widget position.
+ * \param pos Position in widget coordinates, e.g. the cursor or the pinch centroid.
+ * \param anchor Normalized frame point to keep under pos.
+ * \param zoom New zoom factor, clamped to 1..kMaxZoom.
+ */
+void MyWidget::zoomAt(const QPointF &pos, const QPointF &anchor, double zoom)
+{
+    QRectF target = imageTargetRect();
+    if (target.isEmpty())
+        return;
+    zoom = qBound(1.0, zoom, kMaxZoom);
+    double size = 1.0 / zoom;
+    QPointF relative((pos.x() - target.x()) / target.width(), (pos.y() - target.y()) / target.height());
+    QPointF topLeft = anchor - QPointF(relative.x() * size, relative.y() * size);
+    setRoi(zoom, topLeft + QPointF(size / 2, size / 2));
+}
+
+/**
+ * \brief MyWidget::panBy
+ * Moves the zoomed view so the picture follows a drag.
+ * \param delta Drag distance in widget pixels.
+ */
+void MyWidget::panBy(const QPointF &delta)
+{
+    QRectF target = imageTargetRect();
+    if (target.isEmpty())
+        return;
+    QRectF roi = requestedRoi();
+    setRoi(m_zoom, m_zoomCenter - QPointF(delta.x() / target.width() * roi.width(),
+                                          delta.y() / target.height() * roi.height()));
+}
+
+/**
+ * \brief MyWidget::setRoi
+ * Sets the requested region, keeps it inside the frame and schedules sending it to the server.
+ * The view is updated immediately using client-side scaling.
+ * \param zoom Zoom factor, clamped to 1..kMaxZoom.
+ * \param center Normalized center of the region.
+ */
+void MyWidget::setRoi(double zoom, const QPointF &center)
+{
+    zoom = qBound(1.0, zoom, kMaxZoom);
+    double half = 0.5 / zoom;
+    QPointF clamped(qBound(half, center.x(), 1.0 - half), qBound(half, center.y(), 1.0 - half));
+    if (qFuzzyCompare(zoom, m_zoom) && clamped == m_zoomCenter)
+        return;
+    m_zoom = zoom;
+    m_zoomCenter = clamped;
+    update();
+    m_roiTimer.start();
+}
+
+/**
+ * \brief MyWidget::roiToJson
+ * Describes the requested region and the resolution the widget can show it at.
+ * \return JSON object with the normalized region and the output size in device pixels.
+ */
+QJsonObject MyWidget::roiToJson() const
+{
+    QRectF roi = requestedRoi();
+    QSize outputSize = (QSizeF(imageTargetRect().size()) * devicePixelRatioF()).toSize();
+    if (clientUndistortionActive()) {
+        // A region of the undistorted view is no rectangle in the distorted frame: take the whole
+        // frame and crop while remapping, at the resolution the region needs
+        outputSize = (QSizeF(outputSize) * m_zoom).toSize();
+        roi = QRectF(0, 0, 1, 1);
+    }
+    QJsonObject obj;
+    obj["x"] = roi.x();
+    obj["y"] = roi.y();
+    obj["width"] = roi.width();
+    obj["height"] = roi.height();
+    // The server scales the crop to at most this size, so a zoomed view costs no more than a full one
+    obj["output_width"] = outputSize.width();
+    obj["output_height"] = outputSize.height();
+    return obj;
+}
+
+/**
+ * \brief MyWidget::sendRoi
+ * Sends the requested region to the server, which answers with roi_state once it streams it.
+ */
+void MyWidget::sendRoi()
+{
+    if (m_webSocket->state() != QAbstractSocket::ConnectedState || m_rtspStreamUrl.isEmpty() || mosaicActive())
+        return;
+    QJsonObject message = roiToJson();
+    message["type"] = "control";
+    message["command"] = "set_roi";
+    if (m_debugPrint) qDebug() << "[DEBUG] Sending region of interest:" << requestedRoi() << "zoom:" << m_zoom;
+    m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+// Implementation for setTransport, setUdpPort
+void MyWidget::setTransport(TransportProtocol protocol) {
+    if (m_transport == protocol)
+        return;
+    m_transport = protocol;
+    m_activeTransport = initialTransport();
+    if (m_debugPrint) qDebug() << "[DEBUG] setTransport called with" << transportName(m_transport);
+    if (m_batchUpdate)
+        return;
+    applyTransport();
+    startTransportProbe();
+}
+
+/**
+ * \brief MyWidget::applyTransport
+ * Opens or closes the sockets and readers for a changed transport setting. The server is told
+ * with the next set_stream.
+ */
+void MyWidget::applyTransport()
+{
+    m_activeTransport = initialTransport();
+    if (m_activeTransport != SharedMemory) {
+        m_shmSetupTimer.stop();
+        if (m_shmReader)
+            m_shmReader->close();
+    }
+    if (m_activeTransport != Multicast)
+        m_multicastSetupTimer.stop();
+    m_probeTimer.stop();
+    m_reprobeTimer.stop();
+    m_probeActive = false;
+    if (m_activeTransport == UDP) {
+        if (!setupUdpSocket())
+            m_activeTransport = WebSocket;
+    } else {
+        closeUdpSocket(); // Multicast binds once the server has assigned a group; Auto once a probe has chosen UDP
+    }
+}
+void MyWidget::setUdpPort(int port) {
+    if (m_udpPort == port)
+        return;
     m_udpPort = port;
     if (m_debugPrint) qDebug() << "[DEBUG] setUdpPort called with" << port;
     // Recreate UDP socket if transport is already set to UDP
-    if (m_transport == UDP) {
-        setupUdpSocket();
+    if (!m_batchUpdate && m_activeTransport == UDP && !setupUdpSocket()) {
+        fallbackToWebSocket("cannot bind UDP port");
     }
 }
 
+/**
+ * \brief MyWidget::transportFromString
+ * Parses a transport name as used by setTransport and configure.
+ * \param name One of websocket, udp, multicast, shm (or sharedmemory) and auto; case-insensitive.
+ * \param protocol Receives the transport.
+ * \return False if the name is unknown.
+ */
+bool MyWidget::transportFromString(const QString &name, TransportProtocol &protocol)
+{
+    QString protoStr = name.trimmed().toLower();
+    if (protoStr == "udp")
+        protocol = UDP;
+    else if (protoStr == "multicast")
+        protocol = Multicast;
+    else if (protoStr == "shm" || protoStr == "sharedmemory")
+        protocol = SharedMemory;
+    else if (protoStr == "auto")
+        protocol = Auto;
+    else if (protoStr == "websocket")
+        protocol = WebSocket;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * \brief MyWidget::configure
+ * Applies several settings at once, e.g. from a panel's init script. Unlike a sequence of setter
+ * calls this opens at most one connection, binds the UDP socket at most once and sends at most
+ * one set_stream, and only if the relevant values actually changed.
+ * \param settings Mapping of property names to values: webSocketUrl, rtspStreamUrl, transport,
+ * udpPort, frameDropRatio, maxFps, fecGroupSize, flowControlCredits, tileUpdates, streamName,
+ * streamNameBoxPosition, debugMode, debugPrint, priority, frameCacheEnabled, zoomEnabled,
+ * standbyStreams, maxWarmStreams, mosaicStreams, mosaicNames and mosaicColumns.
+ * \param error Receives a message if the mapping is rejected.
+ * \return False if a key is unknown or a value invalid; nothing is applied then.
+ */
+bool MyWidget::configure(const QVariantMap &settings, QString &error)
+{
+    // Keys by value type; every value is checked before anything is applied
+    static const QStringList stringKeys = { "webSocketUrl", "rtspStreamUrl", "transport", "streamName" };
+    static const QStringList intKeys = {
+        "udpPort", "frameDropRatio", "maxFps", "fecGroupSize", "flowControlCredits", "streamNameBoxPosition",
+        "priority", "maxWarmStreams", "mosaicColumns"
+    };
+    static const QStringList boolKeys = { "tileUpdates", "debugMode", "debugPrint", "frameCacheEnabled", "zoomEnabled" };
+    static const QStringList listKeys = { "standbyStreams", "mosaicStreams", "mosaicNames" };
+    for (auto it = settings.constBegin(); it != settings.constEnd(); ++it) {
+        const QString &key = it.key();
+        const QVariant &value = it.value();
+        bool ok = false;
+        if (stringKeys.contains(key)) {
+            ok = value.canConvert<QString>();
+        } else if (intKeys.contains(key)) {
+            int number = value.toInt(&ok);
+            if (ok && value.typeId() == QMetaType::Double)
+                ok = value.toDouble() == number; // toInt() would truncate 2.5 silently
+            if (ok && key == "udpPort")
+                ok = number >= 1 && number <= 65535;
+            else if (ok && key == "streamNameBoxPosition")
+                ok = number >= TopLeft && number <= BottomRight; // setStreamName ignores other values
+        } else if (boolKeys.contains(key)) {
+            // toBool() turns any other string into true
+            QString text = value.toString().toLower();
+            ok = value.typeId() == QMetaType::Bool || text == "true" || text == "false" || text == "1" || text == "0";
+        } else if (listKeys.contains(key)) {
+            ok = value.canConvert<QStringList>();
+        } else {
+            error = QString("Unknown setting '%1'").arg(key);
+            return false;
+        }
+        if (!ok) {
+            error = QString("Invalid value for '%1': '%2'").arg(key, value.toString());
+            return false;
+        }
+    }
+    TransportProtocol transport = m_transport;
+    if (settings.contains("transport") && !transportFromString(settings["transport"].toString(), transport)) {
+        error = QString("Invalid transport protocol: '%1'").arg(settings["transport"].toString());
+        return false;
+    }
+    if (m_debugPrint) qDebug() << "[DEBUG] configure called with" << settings;
+
+    bool connected = m_webSocket->state() == QAbstractSocket::ConnectedState;
+    QString oldWebSocketUrl = m_webSocketUrl;
+    TransportProtocol oldTransport = m_transport;
+    TransportProtocol oldActiveTransport = initialTransport(); // Differs when the mosaic is switched
+    int oldUdpPort = m_udpPort;
+    QString oldRtspStreamUrl = m_rtspStreamUrl;
+    bool oldMosaicActive = mosaicActive();
+    QJsonObject oldSetStream = buildSetStreamMessage();
+
+    m_batchUpdate = true;
+    if (settings.contains("debugPrint")) setDebugPrint(settings["debugPrint"].toBool());
+    if (settings.contains("debugMode")) setDebugMode(settings["debugMode"].toBool());
+    if (settings.contains("webSocketUrl")) setWebSocketUrl(settings["webSocketUrl"].toString());
+    if (settings.contains("transport")) setTransport(transport);
+    if (settings.contains("udpPort")) setUdpPort(settings["udpPort"].toInt());
+    if (settings.contains("frameDropRatio")) setFrameDropRatio(settings["frameDropRatio"].toInt());
+    if (settings.contains("maxFps")) setMaxFps(settings["maxFps"].toInt());
+    if (settings.contains("fecGroupSize")) setFecGroupSize(settings["fecGroupSize"].toInt());
+    if (settings.contains("flowControlCredits")) setFlowControlCredits(settings["flowControlCredits"].toInt());
+    if (settings.contains("tileUpdates")) setTileUpdates(settings["tileUpdates"].toBool());
+    if (settings.contains("frameCacheEnabled")) setFrameCacheEnabled(settings["frameCacheEnabled"].toBool());
+    if (settings.contains("zoomEnabled")) setZoomEnabled(settings["zoomEnabled"].toBool());
+    if (settings.contains("priority")) setPriority(settings["priority"].toInt());
+    if (settings.contains("streamName"))
+        setStreamName(settings["streamName"].toString(), settings.value("streamNameBoxPosition", -1).toInt());
+    else if (settings.contains("streamNameBoxPosition"))
+        setStreamName(m_streamName, settings["streamNameBoxPosition"].toInt());
+    if (settings.contains("standbyStreams")) setStandbyStreams(settings["standbyStreams"].toStringList());
+    if (settings.contains("maxWarmStreams")) setMaxWarmStreams(settings["maxWarmStreams"].toInt());
+    if (settings.contains("rtspStreamUrl")) setRtspStreamUrl(settings["rtspStreamUrl"].toString());
+    if (settings.contains("mosaicNames")) setMosaicNames(settings["mosaicNames"].toStringList());
+    if (settings.contains("mosaicColumns")) setMosaicColumns(settings["mosaicColumns"].toInt());
+    if (settings.contains("mosaicStreams")) setMosaicStreams(settings["mosaicStreams"].toStringList());
+    m_batchUpdate = false;
+
+    if (m_inGedi)
+        return true; // Do not connect in editor
+
+    bool transportChanged = m_transport != oldTransport || initialTransport() != oldActiveTransport;
+    if (m_webSocketUrl != oldWebSocketUrl || !connected) {
+        // onConnected binds the UDP socket and sends set_stream for the new settings
+        if (transportChanged && initialTransport() != UDP)
+            closeUdpSocket();
+        m_activeTransport = initialTransport();
+        if (m_webSocketUrl != oldWebSocketUrl && m_webSocket->state() != QAbstractSocket::UnconnectedState)
+            m_webSocket->abort();
+        if (!m_webSocketUrl.isEmpty() && m_webSocket->state() == QAbstractSocket::UnconnectedState)
+            m_webSocket->open(QUrl(m_webSocketUrl));
+        return true;
+    }
+
+    if (transportChanged || (m_udpPort != oldUdpPort && m_activeTransport == UDP))
+        applyTransport();
+    if (hasStream() && (transportChanged || buildSetStreamMessage() != oldSetStream)) {
+        if (m_activeTransport == Multicast)
+            closeUdpSocket(); // The server assigns the group with the new set_stream
+        sendSetStream();
+    }
+    sendStandby();
+    // A new path is worth probing; unrelated settings must not trigger a UDP burst
+    if (transportChanged || m_rtspStreamUrl != oldRtspStreamUrl || mosaicActive() != oldMosaicActive)
+        startTransportProbe();
+    return true;
+}
+
 void MyWidget::setFrameDropRatio(int ratio) {
     if (m_frameDropRatio == ratio)
         return;
@@ -667,12 +2388,126 @@ void MyWidget::setFrameDropRatio(int ratio) {
     if (m_debugPrint) qDebug() << "[DEBUG] setFrameDropRatio called with" << m_frameDropRatio;
 }
 
-void MyWidget::setupUdpSocket()
+void MyWidget::setMaxFps(int fps) {
+    fps = qMax(0, fps);
+    if (m_maxFps == fps)
+        return;
+    m_maxFps = fps;
+    if (m_debugPrint) qDebug() << "[DEBUG] setMaxFps called with" << m_maxFps;
+    // The cap is part of set_stream, so frames above it are not sent in the first place
+    if (!m_batchUpdate && m_webSocket->state() == QAbstractSocket::ConnectedState && hasStream())
+        sendSetStream();
+}
+
+void MyWidget::setFecGroupSize(int groupSize) {
+    groupSize = qMax(0, groupSize);
+    if (m_fecGroupSize == groupSize)
+        return;
+    m_fecGroupSize = groupSize;
+    if (m_debugPrint) qDebug() << "[DEBUG] setFecGroupSize called with" << m_fecGroupSize;
+    // FEC is negotiated in set_stream; until then server and reassembler would disagree
+    if (!m_batchUpdate && (m_activeTransport == UDP || m_activeTransport == Multicast) &&
+        m_webSocket->state() == QAbstractSocket::ConnectedState && hasStream())
+        sendSetStream();
+}
+
+void MyWidget::setStandbyStreams(const QStringList &urls) {
+    if (m_standbyStreams == urls)
+        return;
+    m_standbyStreams = urls;
+    if (m_debugPrint) qDebug() << "[DEBUG] setStandbyStreams called with" << urls;
+    // Until a promoted stream delivers, its cached frame is shown; load those now
+    if (m_frameCacheEnabled)
+        FrameCache::instance().prewarm(urls);
+    if (!m_batchUpdate)
+        sendStandby();
+}
+
+void MyWidget::setMaxWarmStreams(int count) {
+    count = qBound(0, count, kMaxWarmStreams);
+    if (m_maxWarmStreams == count)
+        return;
+    m_maxWarmStreams = count;
+    if (m_debugPrint) qDebug() << "[DEBUG] setMaxWarmStreams called with" << m_maxWarmStreams;
+    if (!m_batchUpdate)
+        sendStandby();
+}
+
+/**
+ * \brief MyWidget::setMosaicStreams
+ * Switches to mosaic mode: the streams are shown in a grid, all received over the WebSocket.
+ * An empty list returns to the single stream of rtspStreamUrl.
+ * \param urls List of RTSP stream URLs in grid order, at most MosaicView::kMaxTiles.
+ */
+void MyWidget::setMosaicStreams(const QStringList &urls)
+{
+    if (m_mosaicStreams == urls)
+        return;
+    if (m_debugPrint) qDebug() << "[DEBUG] setMosaicStreams called with" << urls.size() << "streams";
+    bool wasActive = mosaicActive();
+    m_mosaicStreams = urls;
+    m_mosaic.setStreams(urls);
+    if (mosaicActive()) {
+        // Zoom, undistortion and the single stream's frame do not apply to the grid
+        m_image = QImage();
+        m_imageIsStale = false;
+        m_lastPayload.clear();
+        m_lastPayloadSize = -1;
+        resetZoom();
+        for (int i = 0; i < m_mosaic.count() && !m_inGedi; ++i)
+            showCachedMosaicTile(m_mosaic.tile(i));
+    } else if (!m_inGedi) {
+        showCachedFrame();
+    }
+    update();
+    if (m_batchUpdate || m_inGedi || m_webSocket->state() != QAbstractSocket::ConnectedState)
+        return;
+    if (wasActive != mosaicActive())
+        applyTransport(); // Mosaic frames always come over the WebSocket
+    if (hasStream())
+        sendSetStream();
+    startTransportProbe();
+}
+
+void MyWidget::setMosaicNames(const QStringList &names)
+{
+    if (m_mosaicNames == names)
+        return;
+    m_mosaicNames = names;
+    m_mosaic.setNames(names);
+    update();
+}
+
+void MyWidget::setMosaicColumns(int columns)
+{
+    columns = qMax(0, columns);
+    if (m_mosaicColumns == columns)
+        return;
+    if (m_debugPrint) qDebug() << "[DEBUG] setMosaicColumns called with" << columns;
+    m_mosaicColumns = columns;
+    m_mosaic.setColumns(columns);
+    update();
+    if (!m_batchUpdate && mosaicActive())
+        m_mosaicLayoutTimer.start(); // The cell size changed
+}
+
+void MyWidget::setFlowControlCredits(int credits) {
+    credits = qBound(0, credits, 16);
+    if (m_flowControlCredits == credits)
+        return;
+    m_flowControlCredits = credits;
+    if (m_debugPrint) qDebug() << "[DEBUG] setFlowControlCredits called with" << m_flowControlCredits;
+    // The window is granted with set_stream
+    if (!m_batchUpdate && m_activeTransport == WebSocket && m_webSocket->state() == QAbstractSocket::ConnectedState && hasStream())
+        sendSetStream();
+}
+
+bool MyWidget::setupUdpSocket()
 {
     closeUdpSocket();
     if (m_udpPort <= 0) {
         if (m_debugPrint) qDebug() << "[DEBUG] setupUdpSocket: Invalid port" << m_udpPort;
-        return;
+        return false;
     }
     
     if (m_debugPrint) qDebug() << "[DEBUG] setupUdpSocket: Attempting to bind on port" << m_udpPort;
@@ -684,7 +2519,7 @@ void MyWidget::setupUdpSocket()
         if (m_debugPrint) qDebug() << "[DEBUG] Failed to bind UDP socket on port" << m_udpPort << "Error:" << m_udpSocket->errorString();
         delete m_udpSocket;
         m_udpSocket = nullptr;
-        return;
+        return false;
     }
     
     connect(m_udpSocket, &QUdpSocket::readyRead, this, &MyWidget::onUdpDatagramReceived);
@@ -694,20 +2529,100 @@ void MyWidget::setupUdpSocket()
             });
     
     if (m_debugPrint) qDebug() << "[DEBUG] UDP socket successfully bound on port" << m_udpPort << "Local address:" << m_udpSocket->localAddress().toString();
+    return true;
 }
 
 void MyWidget::closeUdpSocket()
 {
     if (m_udpSocket) {
+        if (!m_multicastGroup.isNull()) {
+            m_udpSocket->leaveMulticastGroup(m_multicastGroup);
+            if (m_debugPrint) qDebug() << "[DEBUG] Left multicast group" << m_multicastGroup.toString();
+        }
         m_udpSocket->close();
         m_udpSocket->deleteLater();
         m_udpSocket = nullptr;
         if (m_debugPrint) qDebug() << "[DEBUG] UDP socket closed.";
     }
+    m_multicastGroup = QHostAddress();
+}
+
+/**
+ * \brief MyWidget::joinMulticastGroup
+ * Binds the UDP socket to the port assigned by the server and joins the stream's multicast group
+ * on the interface the WebSocket connection uses. Any previously joined group is left first.
+ * If the socket cannot be bound or the group not joined, the stream falls back to the WebSocket.
+ * \param group The multicast group address assigned by the server.
+ * \param port The UDP port the server sends the group's datagrams to.
+ */
+void MyWidget::joinMulticastGroup(const QHostAddress &group, quint16 port)
+{
+    closeUdpSocket();
+
+    m_udpSocket = new QUdpSocket(this);
+    // Several widgets (or processes) on this host may watch the same stream
+    if (!m_udpSocket->bind(QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
+        if (m_debugPrint) qDebug() << "[DEBUG] Failed to bind multicast socket on port" << port << "Error:" << m_udpSocket->errorString();
+        delete m_udpSocket;
+        m_udpSocket = nullptr;
+        fallbackToWebSocket("cannot bind multicast port");
+        return;
+    }
+
+    // Join on the interface that reaches the server, e.g. loopback when the server runs locally
+    QNetworkInterface iface = getLocalInterface();
+    bool joined = iface.isValid() ? m_udpSocket->joinMulticastGroup(group, iface)
+                                  : m_udpSocket->joinMulticastGroup(group);
+    if (!joined) {
+        if (m_debugPrint) qDebug() << "[DEBUG] Failed to join multicast group" << group.toString() << "Error:" << m_udpSocket->errorString();
+        delete m_udpSocket;
+        m_udpSocket = nullptr;
+        fallbackToWebSocket("cannot join multicast group");
+        return;
+    }
+    m_multicastGroup = group;
+
+    connect(m_udpSocket, &QUdpSocket::readyRead, this, &MyWidget::onUdpDatagramReceived);
+    if (m_debugPrint) qDebug() << "[DEBUG] Joined multicast group" << group.toString() << "port:" << port << "interface:" << (iface.isValid() ? iface.humanReadableName() : QString("default"));
+}
+
+/**
+ * \brief MyWidget::getLocalInterface
+ * Finds the network interface that owns the local address of the WebSocket connection.
+ * \return The interface, or an invalid QNetworkInterface if it cannot be determined.
+ */
+QNetworkInterface MyWidget::getLocalInterface()
+{
+    QHostAddress local = m_webSocket->localAddress();
+    bool isIpv4 = false;
+    quint32 ipv4 = local.toIPv4Address(&isIpv4); // Also unwraps IPv4-mapped IPv6 addresses
+    if (isIpv4)
+        local = QHostAddress(ipv4);
+    if (local.isNull())
+        return QNetworkInterface();
+
+    const QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
+    for (const QNetworkInterface &netInterface : interfaces) {
+        const QList<QNetworkAddressEntry> entries = netInterface.addressEntries();
+        for (const QNetworkAddressEntry &entry : entries) {
+            if (entry.ip() == local)
+                return netInterface;
+        }
+    }
+    return QNetworkInterface();
 }
 
 QString MyWidget::getLocalIpAddress()
 {
+    // The address the WebSocket connection uses is the one the server can reach us on
+    bool isIpv4 = false;
+    quint32 wsAddress = m_webSocket->localAddress().toIPv4Address(&isIpv4);
+    if (isIpv4 && wsAddress != 0) {
+        QString ipStr = QHostAddress(wsAddress).toString();
+        if (m_debugPrint) qDebug() << "[DEBUG] Using WebSocket local address:" << ipStr;
+        return ipStr;
+    }
+
     // Get all network interfaces
     QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
     
@@ -783,6 +2698,17 @@ void MyWidget::onUdpDatagramReceived()
         if (bytesRead > 0) {
             if (m_debugPrint) qDebug() << "[DEBUG] UDP datagram received from" << sender.toString() << ":" << senderPort << "size:" << bytesRead;
             datagram.resize(int(bytesRead)); // Resize to actual data size
+            if (datagram.startsWith(kProbeMagic)) {
+                handleProbeDatagram(datagram);
+                continue;
+            }
+            if (FecReassembler::isFecDatagram(datagram)) {
+                // Fragment of an FEC protected frame; lost fragments are rebuilt from parity
+                QByteArray frame;
+                if (m_fec.addDatagram(datagram, frame))
+                    onBinaryMessageReceived(frame);
+                continue;
+            }
             // Reuse the same logic as WebSocket binary message
             onBinaryMessageReceived(datagram);
         } else {
@@ -791,6 +2717,210 @@ void MyWidget::onUdpDatagramReceived()
     }
 }
 
+/**
+ * \brief MyWidget::openSharedMemory
+ * Attaches to the frame ring announced by the server. Falls back to WebSocket if that fails,
+ * e.g. because the server runs on another host or under another user.
+ * \param memoryKey Native key of the shared memory segment.
+ * \param semaphoreKey Key of the semaphore the server releases after each frame.
+ */
+void MyWidget::openSharedMemory(const QString &memoryKey, const QString &semaphoreKey)
+{
+    if (!m_shmReader) {
+        m_shmReader = new ShmFrameReader(this);
+        // Emitted from the reader's notification thread
+        connect(m_shmReader, &ShmFrameReader::frameAvailable, this, &MyWidget::onShmFrameAvailable, Qt::QueuedConnection);
+    }
+    if (memoryKey.isEmpty() || semaphoreKey.isEmpty() || !m_shmReader->open(memoryKey, semaphoreKey)) {
+        fallbackToWebSocket(memoryKey.isEmpty() || semaphoreKey.isEmpty() ? QString("incomplete shm_info") : m_shmReader->errorString());
+        return;
+    }
+    if (m_debugPrint) qDebug() << "[DEBUG] Attached to shared memory frame ring" << memoryKey;
+}
+
+/**
+ * \brief MyWidget::fallbackToWebSocket
+ * Gives up on shared memory or UDP for the current connection and requests the stream over the
+ * WebSocket. The configured transport is kept, so the next connection tries it again.
+ * \param reason Why the transport cannot be used, for debug output.
+ */
+void MyWidget::fallbackToWebSocket(const QString &reason)
+{
+    if (m_activeTransport == WebSocket)
+        return;
+    if (m_debugPrint) qDebug() << "[DEBUG]" << transportName(m_activeTransport) << "transport unavailable (" << reason << "), falling back to WebSocket";
+    m_shmSetupTimer.stop();
+    m_multicastSetupTimer.stop();
+    if (m_shmReader)
+        m_shmReader->close();
+    if (m_activeTransport == UDP || m_activeTransport == Multicast)
+        closeUdpSocket();
+    m_activeTransport = WebSocket;
+    if (m_webSocket->state() == QAbstractSocket::ConnectedState && hasStream())
+        sendSetStream();
+    update();
+}
+
+/**
+ * \brief MyWidget::startTransportProbe
+ * In Auto mode, asks the server for a short burst of UDP probe datagrams, each mirrored by a
+ * probe_ws text message on the WebSocket. finishTransportProbe() compares both paths.
+ */
+void MyWidget::startTransportProbe()
+{
+    if (m_transport != Auto || m_probeActive || m_rtspStreamUrl.isEmpty() || mosaicActive() ||
+        m_webSocket->state() != QAbstractSocket::ConnectedState)
+        return;
+    if (!m_udpSocket && !setupUdpSocket()) {
+        // Port in use or not allowed: stay on the WebSocket and try again later
+        m_probeResult = "UDP bind failed";
+        if (m_debugPrint) qDebug() << "[DEBUG] Transport probe: cannot bind UDP port" << m_udpPort;
+        m_reprobeTimer.start();
+        return;
+    }
+    m_probeActive = true;
+    m_probeId++;
+    m_probeUdpReceived = 0;
+    m_probeUdpDelaySum = 0;
+    m_probeWsReceived = 0;
+    m_probeWsDelaySum = 0;
+
+    QJsonObject message;
+    message["type"] = "control";
+    message["command"] = "probe_udp";
+    message["probe_id"] = qint64(m_probeId);
+    message["count"] = kProbeCount;
+    message["interval_ms"] = kProbeIntervalMs;
+    message["udp_port"] = m_udpPort;
+    QString localIp = getLocalIpAddress();
+    if (!localIp.isEmpty())
+        message["udp_ip"] = localIp;
+    if (m_debugPrint) qDebug() << "[DEBUG] Starting transport probe" << m_probeId;
+    m_webSocket->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    m_probeTimer.start();
+}
+
+/**
+ * \brief MyWidget::handleProbeDatagram
+ * Counts a UDP probe datagram of the running probe and its one-way delay.
+ * \param datagram The datagram, starting with kProbeMagic.
+ */
+void MyWidget::handleProbeDatagram(const QByteArray &datagram)
+{
+    if (!m_probeActive || datagram.size() < kProbeDatagramSize)
+        return;
+    const uchar *data = reinterpret_cast<const uchar *>(datagram.constData());
+    if (qFromBigEndian<quint32>(data + 4) != m_probeId)
+        return; // Late datagram of an earlier probe
+    qint64 serverTimestamp = qFromBigEndian<qint64>(data + 12);
+    m_probeUdpReceived++;
+    m_probeUdpDelaySum += QDateTime::currentMSecsSinceEpoch() - serverTimestamp;
+}
+
+/**
+ * \brief MyWidget::finishTransportProbe
+ * Chooses UDP if its probe loss is low and its delay is not worse than the WebSocket's,
+ * otherwise the WebSocket, and switches the stream if the choice changed.
+ */
+void MyWidget::finishTransportProbe()
+{
+    if (!m_probeActive)
+        return;
+    m_probeActive = false;
+    m_autoFreezeCount = 0;
+    m_reprobeTimer.start();
+
+    double loss = 1.0 - double(m_probeUdpReceived) / kProbeCount;
+    double udpDelay = m_probeUdpReceived > 0 ? m_probeUdpDelaySum / m_probeUdpReceived : -1;
+    // Older servers do not mirror the probe; the frame delay is the next best WebSocket figure
+    double wsDelay = m_probeWsReceived > 0 ? m_probeWsDelaySum / m_probeWsReceived
+                                           : (m_activeTransport == WebSocket ? double(m_currentDelayMs) : -1);
+    bool useUdp = m_probeUdpReceived > 0 && loss <= kMaxProbeLoss &&
+                  (wsDelay < 0 || udpDelay <= wsDelay + kProbeDelayMarginMs);
+    TransportProtocol chosen = useUdp ? UDP : WebSocket;
+    m_probeResult = QString("UDP loss %1 %, delay %2 ms; WebSocket delay %3 ms")
+                        .arg(qRound(loss * 100))
+                        .arg(udpDelay >= 0 ? QString::number(udpDelay, 'f', 1) : QString("N/A"))
+                        .arg(wsDelay >= 0 ? QString::number(wsDelay, 'f', 1) : QString("N/A"));
+    if (m_debugPrint) qDebug() << "[DEBUG] Transport probe" << m_probeId << ":" << m_probeResult << "-> " << transportName(chosen);
+
+    if (chosen == m_activeTransport) {
+        if (chosen == WebSocket)
+            closeUdpSocket(); // Bound only for the probe
+        return;
+    }
+    if (chosen == WebSocket)
+        closeUdpSocket();
+    m_activeTransport = chosen;
+    sendSetStream();
+    update();
+}
+
+/**
+ * \brief MyWidget::onShmFrameAvailable
+ * Slot called when the server has written a frame into the shared memory ring. Only the newest
+ * frame is read, frames written in between are skipped.
+ */
+void MyWidget::onShmFrameAvailable()
+{
+    if (!m_shmReader || m_activeTransport != SharedMemory)
+        return;
+    QElapsedTimer cpuTimer; // Time on the GUI thread, accounted to the CPU governor
+    cpuTimer.start();
+    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
+    if (m_governorLevel >= CpuGovernor::SkipFrames && (m_governorFrameCounter++ % 2) != 0) {
+        // Over the CPU budget: drop every second frame without decoding it
+        m_shmReader->skipLatest();
+        m_governorSkippedFrames++;
+        m_lastFrameTimestamp = currentTime;
+        return;
+    }
+
+    QImage image;
+    QByteArray jpeg;
+    qint64 serverTimestamp = 0;
+    ShmFrameReader::Result result = m_shmReader->readLatest(image, serverTimestamp, jpeg);
+    if (result == ShmFrameReader::NoFrame)
+        return; // Same frame as on screen, or overwritten while reading
+    if (m_imageIsStale) {
+        m_imageIsStale = false;
+        m_image = QImage();
+    }
+    qint64 prevDelay = m_currentDelayMs;
+    qint64 prevImageKey = m_image.cacheKey();
+    QString prevStatus = m_statusText;
+    m_lastServerTimestamp = serverTimestamp;
+    m_currentDelayMs = currentTime - m_lastServerTimestamp;
+
+    bool overCutoff = m_currentDelayMs > kLatencyCutoffMs;
+    if (!m_debugMode && overCutoff) {
+        if (m_statusText != statusMsg.considerableLatency) {
+            m_statusText = statusMsg.considerableLatency;
+            m_image = QImage(); // Clear image
+        }
+    } else if (result == ShmFrameReader::Decoded) {
+        m_image = image;
+        if (!m_statusText.isEmpty())
+            m_statusText = QString();
+        m_lastFrameTimestamp = currentTime;
+        if (m_frameCacheEnabled && !jpeg.isEmpty() && m_activeRoi == QRectF(0, 0, 1, 1))
+            FrameCache::instance().store(m_rtspStreamUrl, jpeg, m_lastServerTimestamp); // Not while cropped
+        m_lastPayloadSize = -1; // Ring frames are identified by their sequence number instead
+        m_lastPayload = jpeg;   // Empty for raw frames, which are then encoded for snapshots
+        m_lastPayloadTimestamp = m_lastServerTimestamp;
+    } else {
+        if (m_debugPrint) qDebug() << "[DEBUG] Failed to decode shared memory frame" << m_shmReader->sequence();
+        if (m_statusText != statusMsg.errorDecoding) {
+            m_statusText = statusMsg.errorDecoding;
+            m_image = QImage(); // Clear image on error
+        }
+    }
+    m_overLatencyCutoff = (m_debugMode && overCutoff);
+    if (prevStatus != m_statusText || (m_debugMode && prevDelay != m_currentDelayMs) || prevImageKey != m_image.cacheKey())
+        schedulePresent(rect());
+    CpuGovernor::instance().addUsage(this, cpuTimer.nsecsElapsed());
+}
+
 void MyWidget::setStreamName(const QString &name, int position) {
     m_streamName = name;
     if (position >= 1 && position <= 4)
@@ -811,6 +2941,75 @@ void MyWidget::setStreamNameBoxPosition(BoxPosition pos) {
     update();
 }
 
+void MyWidget::setFrameCacheEnabled(bool enabled)
+{
+    if (m_frameCacheEnabled == enabled)
+        return;
+    m_frameCacheEnabled = enabled;
+    if (m_debugPrint) qDebug() << "[DEBUG] setFrameCacheEnabled called with" << enabled;
+    if (!m_frameCacheEnabled && m_imageIsStale) {
+        m_imageIsStale = false;
+        m_image = QImage();
+        update();
+    }
+    for (int i = 0; i < m_mosaic.count() && !m_frameCacheEnabled; ++i) {
+        MosaicTile &tile = m_mosaic.tile(i);
+        if (tile.imageIsStale) {
+            tile.imageIsStale = false;
+            tile.image = QImage();
+            update(m_mosaic.cellRect(i, rect()));
+        }
+    }
+}
+
+/**
+ * \brief MyWidget::prewarmFrameCache
+ * Loads the cached frames of the given streams into memory in the background, e.g. from a
+ * panel's init script before the widgets of the next panel are created.
+ * \param urls List of RTSP stream URLs.
+ */
+void MyWidget::prewarmFrameCache(const QStringList &urls)
+{
+    if (m_debugPrint) qDebug() << "[DEBUG] prewarmFrameCache called with" << urls.size() << "streams";
+    FrameCache::instance().prewarm(urls);
+}
+
+void MyWidget::setZoomEnabled(bool enabled)
+{
+    if (m_zoomEnabled == enabled)
+        return;
+    m_zoomEnabled = enabled;
+    if (m_debugPrint) qDebug() << "[DEBUG] setZoomEnabled called with" << enabled;
+    if (!m_zoomEnabled)
+        resetZoom();
+}
+
+void MyWidget::setTileUpdates(bool enabled)
+{
+    if (m_tileUpdates == enabled)
+        return;
+    m_tileUpdates = enabled;
+    if (m_debugPrint) qDebug() << "[DEBUG] setTileUpdates called with" << enabled;
+    // The frame format changes, so tell the server right away
+    if (!m_batchUpdate && m_webSocket->state() == QAbstractSocket::ConnectedState && !m_rtspStreamUrl.isEmpty())
+        sendSetStream();
+}
+
+void MyWidget::setPriority(int priority)
+{
+    if (m_priority == priority)
+        return;
+    m_priority = priority;
+    if (m_debugPrint) qDebug() << "[DEBUG] setPriority called with" << priority;
+    CpuGovernor::instance().setPriority(this, priority);
+}
+
+void MyWidget::resetZoom()
+{
+    m_panning = false;
+    setRoi(1.0, QPointF(0.5, 0.5));
+}
+
 // Add getters for Q_PROPERTY
 QString MyWidget::getStreamName() const { return m_streamName; }
 MyWidget::BoxPosition MyWidget::getStreamNameBoxPosition() const { return m_streamNameBoxPosition; }
@@ -819,7 +3018,19 @@ QString MyWidget::getRtspStreamUrl() const { return m_rtspStreamUrl; }
 MyWidget::TransportProtocol MyWidget::getTransport() const { return m_transport; }
 int MyWidget::getUdpPort() const { return m_udpPort; }
 int MyWidget::getFrameDropRatio() const { return m_frameDropRatio; }
+int MyWidget::getMaxFps() const { return m_maxFps; }
+int MyWidget::getFecGroupSize() const { return m_fecGroupSize; }
+int MyWidget::getFlowControlCredits() const { return m_flowControlCredits; }
+QStringList MyWidget::getStandbyStreams() const { return m_standbyStreams; }
+QStringList MyWidget::getMosaicStreams() const { return m_mosaicStreams; }
+QStringList MyWidget::getMosaicNames() const { return m_mosaicNames; }
+int MyWidget::getMosaicColumns() const { return m_mosaicColumns; }
+int MyWidget::getMaxWarmStreams() const { return m_maxWarmStreams; }
 bool MyWidget::isInGedi() const { return m_inGedi; }
+bool MyWidget::getFrameCacheEnabled() const { return m_frameCacheEnabled; }
+bool MyWidget::getZoomEnabled() const { return m_zoomEnabled; }
+bool MyWidget::getTileUpdates() const { return m_tileUpdates; }
+int MyWidget::getPriority() const { return m_priority; }
 
 //--------------------------------------------------------------------------------
 // Here comes the implementation of the EWO interface class
@@ -839,6 +3050,12 @@ streamingEWO::streamingEWO(QWidget *parent)
   // the widget will be deleted by the QWidget parent
   // Don't do it in destructor
   baseWidget = new MyWidget(parent);
+  connect(baseWidget, &MyWidget::snapshotSaved, this, [this](const QString &path, bool success, const QString &error) {
+      emit signal("snapshotSaved", QVariantList() << path << success << error);
+  });
+  connect(baseWidget, &MyWidget::mosaicTileClicked, this, [this](int index, const QString &url) {
+      emit signal("mosaicTileClicked", QVariantList() << index << url);
+  });
 }
 
 //--------------------------------------------------------------------------------
@@ -857,13 +3074,16 @@ QWidget *streamingEWO::widget() const
 
 /**
  * \brief streamingEWO::signalList
- * Returns the list of signals supported by this EWO (currently empty).
- * \return QStringList of supported signal names (empty in this implementation).
+ * Returns the list of signals supported by this EWO.
+ * \return QStringList of supported signal signatures.
  */
 QStringList streamingEWO::signalList() const
 {
   QStringList list;
 
+  list.append("snapshotSaved(string path, bool success, string error)");
+  list.append("mosaicTileClicked(int index, string url)");
+
   return list;
 }
 
@@ -885,7 +3105,25 @@ QStringList streamingEWO::methodList() const
   list.append("void setTransport(string transport)");
   list.append("void setUdpPort(int port)"); // Add UDP port method
   list.append("void setFrameDropRatio(int ratio)"); // Add frame drop ratio method
+  list.append("void setMaxFps(int fps)");
+  list.append("void setFecGroupSize(int groupSize)");
+  list.append("void setFlowControlCredits(int credits)");
+  list.append("void setStandbyStreams(dyn_string urls)");
+  list.append("void setMaxWarmStreams(int count)");
+  list.append("void setMosaicStreams(dyn_string urls)");
+  list.append("void setMosaicNames(dyn_string names)");
+  list.append("void setMosaicColumns(int columns)");
   list.append("void setStreamName(string name, int position=-1)");
+  list.append("void setFrameCacheEnabled(bool enabled)");
+  list.append("void prewarmFrameCache(dyn_string urls)");
+  list.append("void setZoomEnabled(bool enabled)");
+  list.append("void resetZoom()");
+  list.append("void setTileUpdates(bool enabled)");
+  list.append("void setPriority(int priority)");
+  list.append("void setCpuBudget(int percent)");
+  list.append("mapping getStatistics()");
+  list.append("bool configure(mapping settings)");
+  list.append("bool saveSnapshot(string path, string format=\"\", int quality=-1)");
 
   return list;
 }
@@ -953,6 +3191,48 @@ bool streamingEWO::methodInterface(const QString &name, QVariant::Type &retVal,
     args.append(QVariant::Int);
     return true;
   }
+  if ( name == "setMaxFps" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Int);
+    return true;
+  }
+  if ( name == "setFecGroupSize" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Int);
+    return true;
+  }
+  if ( name == "setFlowControlCredits" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Int);
+    return true;
+  }
+  if ( name == "setStandbyStreams" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::StringList);
+    return true;
+  }
+  if ( name == "setMaxWarmStreams" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Int);
+    return true;
+  }
+  if ( name == "setMosaicStreams" || name == "setMosaicNames" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::StringList);
+    return true;
+  }
+  if ( name == "setMosaicColumns" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Int);
+    return true;
+  }
   if ( name == "setStreamName" )
   {
     retVal = QVariant::Invalid;
@@ -960,6 +3240,66 @@ bool streamingEWO::methodInterface(const QString &name, QVariant::Type &retVal,
     args.append(QVariant::Int); // Optional, but always present in interface
     return true;
   }
+  if ( name == "setFrameCacheEnabled" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Bool);
+    return true;
+  }
+  if ( name == "prewarmFrameCache" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::StringList);
+    return true;
+  }
+  if ( name == "setZoomEnabled" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Bool);
+    return true;
+  }
+  if ( name == "resetZoom" )
+  {
+    retVal = QVariant::Invalid;
+    return true;
+  }
+  if ( name == "setTileUpdates" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Bool);
+    return true;
+  }
+  if ( name == "setPriority" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Int);
+    return true;
+  }
+  if ( name == "setCpuBudget" )
+  {
+    retVal = QVariant::Invalid;
+    args.append(QVariant::Int);
+    return true;
+  }
+  if ( name == "getStatistics" )
+  {
+    retVal = QVariant::Map;
+    return true;
+  }
+  if ( name == "configure" )
+  {
+    retVal = QVariant::Bool;
+    args.append(QVariant::Map);
+    return true;
+  }
+  if ( name == "saveSnapshot" )
+  {
+    retVal = QVariant::Bool;
+    args.append(QVariant::String);
+    args.append(QVariant::String); // Optional, but always present in interface
+    args.append(QVariant::Int);    // Optional, but always present in interface
+    return true;
+  }
 
   return false;
 }
@@ -1015,14 +3355,9 @@ QVariant streamingEWO::invokeMethod(const QString &name, QList<QVariant> &values
   if ( name == "setTransport" )
   {
     if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
-    QString protoStr = values[0].toString().trimmed().toLower();
     MyWidget::TransportProtocol proto = MyWidget::WebSocket;
-    if (protoStr == "udp")
-      proto = MyWidget::UDP;
-    else if (protoStr == "websocket")
-      proto = MyWidget::WebSocket;
-    else {
-      error = QString("Invalid transport protocol: '%1'. Use 'udp' or 'websocket'.").arg(protoStr);
+    if (!MyWidget::transportFromString(values[0].toString(), proto)) {
+      error = QString("Invalid transport protocol: '%1'. Use 'udp', 'multicast', 'shm', 'auto' or 'websocket'.").arg(values[0].toString().trimmed().toLower());
       return QVariant();
     }
     baseWidget->setTransport(proto);
@@ -1043,6 +3378,62 @@ QVariant streamingEWO::invokeMethod(const QString &name, QList<QVariant> &values
     return QVariant();
   }
 
+  if ( name == "setMaxFps" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setMaxFps(values[0].toInt());
+    return QVariant();
+  }
+
+  if ( name == "setFecGroupSize" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setFecGroupSize(values[0].toInt());
+    return QVariant();
+  }
+
+  if ( name == "setFlowControlCredits" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setFlowControlCredits(values[0].toInt());
+    return QVariant();
+  }
+
+  if ( name == "setStandbyStreams" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setStandbyStreams(values[0].toStringList());
+    return QVariant();
+  }
+
+  if ( name == "setMaxWarmStreams" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setMaxWarmStreams(values[0].toInt());
+    return QVariant();
+  }
+
+  if ( name == "setMosaicStreams" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setMosaicStreams(values[0].toStringList());
+    return QVariant();
+  }
+
+  if ( name == "setMosaicNames" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setMosaicNames(values[0].toStringList());
+    return QVariant();
+  }
+
+  if ( name == "setMosaicColumns" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setMosaicColumns(values[0].toInt());
+    return QVariant();
+  }
+
   if ( name == "setStreamName" )
   {
     if (values.size() == 1)
@@ -1052,5 +3443,76 @@ QVariant streamingEWO::invokeMethod(const QString &name, QList<QVariant> &values
     return QVariant();
   }
 
+  if ( name == "setFrameCacheEnabled" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setFrameCacheEnabled(values[0].toBool());
+    return QVariant();
+  }
+
+  if ( name == "prewarmFrameCache" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->prewarmFrameCache(values[0].toStringList());
+    return QVariant();
+  }
+
+  if ( name == "setZoomEnabled" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setZoomEnabled(values[0].toBool());
+    return QVariant();
+  }
+
+  if ( name == "resetZoom" )
+  {
+    baseWidget->resetZoom();
+    return QVariant();
+  }
+
+  if ( name == "setTileUpdates" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setTileUpdates(values[0].toBool());
+    return QVariant();
+  }
+
+  if ( name == "setPriority" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    baseWidget->setPriority(values[0].toInt());
+    return QVariant();
+  }
+
+  if ( name == "setCpuBudget" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    // The budget is shared by all widgets of the UI process
+    CpuGovernor::instance().setBudgetPercent(values[0].toInt());
+    return QVariant();
+  }
+
+  if ( name == "getStatistics" )
+  {
+    return baseWidget->getStatistics();
+  }
+
+  if ( name == "configure" )
+  {
+    if ( !hasNumArgs(name, values, 1, error) ) return QVariant();
+    return baseWidget->configure(values[0].toMap(), error);
+  }
+
+  if ( name == "saveSnapshot" )
+  {
+    if (values.isEmpty()) {
+      error = QString("%1 needs at least the target path").arg(name);
+      return QVariant();
+    }
+    QString format = values.size() >= 2 ? values[1].toString() : QString();
+    int quality = values.size() >= 3 ? values[2].toInt() : -1;
+    return baseWidget->saveSnapshot(values[0].toString(), format, quality);
+  }
+
   return BaseExternWidget::invokeMethod(name, values, error);
 }
\ No newline at end of file
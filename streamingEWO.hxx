@@ -6,6 +6,18 @@
 #include <QImage>
 #include <QTimer>
 #include <QUdpSocket>
+#include <QHostAddress>
+#include <QNetworkInterface>
+#include <QJsonObject>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <udpFec.hxx>
+#include <shmTransport.hxx>
+#include <lensUndistort.hxx>
+#include <mosaicView.hxx>
+#include <incrementalDecoder.hxx>
+
+class QPainter;
 
 //--------------------------------------------------------------------------------
 // this is the real widget (an ordinary Qt widget), which can also use Q_PROPERTY
@@ -25,7 +37,10 @@ public:
     // Enum for transport protocol
     enum TransportProtocol {
         WebSocket,
-        UDP
+        UDP,
+        Multicast,
+        SharedMemory,  // Frame ring in shared memory, StreamServer on the same host
+        Auto           // UDP or WebSocket, chosen by probing after connecting
     };
     Q_ENUM(TransportProtocol)
 
@@ -39,6 +54,18 @@ public:
   Q_PROPERTY(int frameDropRatio READ getFrameDropRatio WRITE setFrameDropRatio DESIGNABLE true SCRIPTABLE true)
   Q_PROPERTY(QString streamName READ getStreamName WRITE setStreamName DESIGNABLE true SCRIPTABLE true)
   Q_PROPERTY(BoxPosition streamNameBoxPosition READ getStreamNameBoxPosition WRITE setStreamNameBoxPosition DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(bool frameCacheEnabled READ getFrameCacheEnabled WRITE setFrameCacheEnabled DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(bool zoomEnabled READ getZoomEnabled WRITE setZoomEnabled DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(bool tileUpdates READ getTileUpdates WRITE setTileUpdates DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(int priority READ getPriority WRITE setPriority DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(int maxFps READ getMaxFps WRITE setMaxFps DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(int fecGroupSize READ getFecGroupSize WRITE setFecGroupSize DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(QStringList standbyStreams READ getStandbyStreams WRITE setStandbyStreams DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(int maxWarmStreams READ getMaxWarmStreams WRITE setMaxWarmStreams DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(QStringList mosaicStreams READ getMosaicStreams WRITE setMosaicStreams DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(QStringList mosaicNames READ getMosaicNames WRITE setMosaicNames DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(int mosaicColumns READ getMosaicColumns WRITE setMosaicColumns DESIGNABLE true SCRIPTABLE true)
+  Q_PROPERTY(int flowControlCredits READ getFlowControlCredits WRITE setFlowControlCredits DESIGNABLE true SCRIPTABLE true)
   Q_PROPERTY(bool inGedi READ isInGedi WRITE setInGedi DESIGNABLE false SCRIPTABLE false)
 
 
@@ -60,32 +87,127 @@ public:
     int getUdpPort() const;
     void setFrameDropRatio(int ratio);
     int getFrameDropRatio() const;
+    void setMaxFps(int fps);
+    int getMaxFps() const;
+    void setFecGroupSize(int groupSize);
+    int getFecGroupSize() const;
+    void setStandbyStreams(const QStringList &urls);
+    QStringList getStandbyStreams() const;
+    void setMaxWarmStreams(int count);
+    int getMaxWarmStreams() const;
+    void setMosaicStreams(const QStringList &urls);
+    QStringList getMosaicStreams() const;
+    void setMosaicNames(const QStringList &names);
+    QStringList getMosaicNames() const;
+    void setMosaicColumns(int columns);
+    int getMosaicColumns() const;
+    void setFlowControlCredits(int credits);
+    int getFlowControlCredits() const;
     void setStreamName(const QString &name, int position = -1);
     QString getStreamName() const;
     BoxPosition getStreamNameBoxPosition() const;
     void setStreamNameBoxPosition(BoxPosition pos);
     bool isInGedi() const;
     void setInGedi(bool inGedi);
+    void setFrameCacheEnabled(bool enabled);
+    bool getFrameCacheEnabled() const;
+    void prewarmFrameCache(const QStringList &urls);
+    void setZoomEnabled(bool enabled);
+    bool getZoomEnabled() const;
+    void resetZoom();
+    void setTileUpdates(bool enabled);
+    bool getTileUpdates() const;
+    void setPriority(int priority);
+    int getPriority() const;
+    QVariantMap getStatistics() const;
+    bool saveSnapshot(const QString &path, const QString &format = QString(), int quality = -1);
+    bool configure(const QVariantMap &settings, QString &error);
+    static bool transportFromString(const QString &name, TransportProtocol &protocol);
+
+  signals:
+    // Reported from the GUI thread once a snapshot was written or has failed
+    void snapshotSaved(const QString &path, bool success, const QString &error);
+    // A tile of the mosaic was clicked or tapped
+    void mosaicTileClicked(int index, const QString &url);
 
   protected:
     virtual void paintEvent(QPaintEvent *event);
     virtual void mousePressEvent(QMouseEvent *event);
+    virtual void mouseMoveEvent(QMouseEvent *event);
+    virtual void mouseReleaseEvent(QMouseEvent *event);
+    virtual void mouseDoubleClickEvent(QMouseEvent *event);
+    virtual void wheelEvent(QWheelEvent *event);
+    virtual void resizeEvent(QResizeEvent *event);
     virtual bool event(QEvent *event); // Add generic event handler for touch events
 
   private slots:
     void onConnected();
+    void onBinaryFrameReceived(const QByteArray &frame, bool isLastFrame);
     void onBinaryMessageReceived(const QByteArray &message);
     void onDisconnected();
     void checkConnectionStatus();
     void onUdpDatagramReceived();
     void onTextMessageReceived(const QString &message);
+    void onGovernorLevelChanged(QObject *client, int level);
+    void present();
+    void onShmFrameAvailable();
 
   private:
-    void setupUdpSocket();
+    bool setupUdpSocket();
+    void applyTransport();
     void closeUdpSocket();
+    void joinMulticastGroup(const QHostAddress &group, quint16 port);
     QString getLocalIpAddress();
+    QNetworkInterface getLocalInterface();
+    QJsonObject buildSetStreamMessage();
+    void sendSetStream();
+    bool hasStream() const;
+    bool mosaicActive() const;
+    TransportProtocol initialTransport() const;
+    QJsonObject buildSetMosaicMessage() const;
+    void handleMosaicFrame(const QByteArray &message);
+    bool setMosaicTileStatus(MosaicTile &tile, const QString &status);
+    bool showCachedMosaicTile(MosaicTile &tile);
+    bool showCachedMosaicJpeg(MosaicTile &tile, const QByteArray &jpeg, qint64 serverTimestamp);
+    void paintMosaic(QPainter &painter, const QRegion &region);
+    QStringList warmStreams() const;
+    void sendStandby();
+    void openSharedMemory(const QString &memoryKey, const QString &semaphoreKey);
+    void fallbackToWebSocket(const QString &reason);
+    void startTransportProbe();
+    void finishTransportProbe();
+    void handleProbeDatagram(const QByteArray &datagram);
+    bool showCachedFrame();
+    bool showCachedJpeg(const QByteArray &jpeg, qint64 serverTimestamp);
+    QRect imageTargetRect() const;
+    QRectF imageSourceRect() const;
+    QRectF requestedRoi() const;
+    QPointF widgetToFrame(const QPointF &pos) const;
+    void zoomAt(const QPointF &pos, const QPointF &anchor, double zoom);
+    void panBy(const QPointF &delta);
+    void setRoi(double zoom, const QPointF &center);
+    void sendRoi();
+    QJsonObject roiToJson() const;
+    void toggleUndistortion();
+    bool clientUndistortionActive() const;
+    double undistortionAlpha() const;
+    bool incrementalDecodeWanted() const;
+    bool decodeFrame(QByteArrayView imageData, QImage &image);
+    int frameHeaderSize() const;
+    const QImage &scaledFrame(const QRect &targetRect, const QRectF &sourceRect);
+    bool applyTileUpdate(QByteArrayView data, QRegion &dirtyRegion);
+    void requestKeyframe();
+    bool creditsActive() const;
+    void returnCredit();
+    void sendCredits(int credits, bool reset);
+    void sendResolutionScale();
+    void schedulePresent(const QRegion &region);
+    int presentIntervalMs() const;
+    void drawStatusBox(QPainter &painter, const QString &text, const QRect &area);
+    void drawNameBox(QPainter &painter, const QString &text, const QRect &area);
 
     QWebSocket *m_webSocket;
+    bool m_batchUpdate = false; // Inside configure(): setters only store, connection changes are applied once at the end
     QImage m_image;
     QString m_statusText;
     QTimer m_connectionStatusTimer;
@@ -98,19 +220,107 @@ public:
     bool m_overLatencyCutoff = false; // New member to track latency cutoff
     qint64 m_currentDelayMs; // New member to store current delay
     TransportProtocol m_transport = WebSocket;
+    TransportProtocol m_activeTransport = WebSocket; // Transport in use; WebSocket after a shared memory fallback
     int m_udpPort = 4635;
     int m_frameDropRatio = 1; // Default to no frame dropping (1 = keep all frames)
+    int m_maxFps = 0; // 0 = no limit besides the display refresh rate
     QUdpSocket* m_udpSocket = nullptr;
+    int m_fecGroupSize = 0; // Data fragments per XOR parity fragment on UDP, 0 = no FEC
+    FecReassembler m_fec;
+    // Warm-standby streams the server keeps open at a low rate for instant switching
+    QStringList m_standbyStreams;
+    int m_maxWarmStreams = 2;      // Bounds the server load, 0 = no standby streams
+    QStringList m_warmStreams;     // Standby streams the server currently holds for this widget
+    quint64 m_standbyPromotions = 0;
+    // Mosaic mode: several streams in a grid, multiplexed over the WebSocket
+    QStringList m_mosaicStreams;
+    QStringList m_mosaicNames;
+    int m_mosaicColumns = 0;       // 0 = as square as possible
+    MosaicView m_mosaic;
+    QTimer m_mosaicLayoutTimer;    // Debounces set_mosaic with the new cell size after a resize
+    // Credit-based flow control on the WebSocket: the server sends a frame only while it holds a credit
+    int m_flowControlCredits = 2;  // Frames in flight granted to the server, 0 = no flow control
+    int m_pendingCredits = 0;      // Frames handled but not yet credited back
+    quint32 m_creditEpoch = 0;       // Incremented with every fresh window granted to the server
+    quint32 m_serverCreditEpoch = 0; // Last epoch the server confirmed with credit_epoch
+    quint64 m_creditsReturned = 0;
+    quint64 m_creditResets = 0;
+    QHostAddress m_multicastGroup; // Group assigned by the server, null when not joined
+    QTimer m_multicastSetupTimer;  // Falls back to WebSocket if the server assigns no group
+    ShmFrameReader *m_shmReader = nullptr;
+    QTimer m_shmSetupTimer;        // Falls back to WebSocket if the server does not offer shared memory
+    // Automatic transport selection: UDP probe bursts compared with the WebSocket path
+    QTimer m_probeTimer;           // Ends a running probe
+    QTimer m_reprobeTimer;         // Periodic re-evaluation
+    bool m_probeActive = false;
+    quint32 m_probeId = 0;
+    int m_probeUdpReceived = 0;
+    double m_probeUdpDelaySum = 0;
+    int m_probeWsReceived = 0;
+    double m_probeWsDelaySum = 0;
+    int m_autoFreezeCount = 0;     // Freezes on UDP since the last probe
+    QString m_probeResult;         // Outcome of the last probe, for the debug overlay and statistics
     QTimer* m_reconnectTimer = nullptr;
     // Stream name overlay members
     QString m_streamName;
     BoxPosition m_streamNameBoxPosition = TopLeft;
     bool m_inGedi = false;
+    // Last-frame cache members
+    bool m_frameCacheEnabled = true;
+    bool m_imageIsStale = false; // m_image comes from the frame cache, not from the live stream
+    qint64 m_staleServerTimestamp = 0;
     // Undistortion members
     bool m_undistortionAvailable = false;
     bool m_undistortionEnabled = false;
     int m_undistortionMode = 0; // 0=off, 1=alpha=0.0, 2=alpha=0.4
     QRect m_undistortButtonRect;
+    LensRemap m_lensRemap;                     // Calibration from camera_calibration; undistortion is then done locally
+    // Region-of-interest zoom members, all rects are normalized to the full camera frame
+    bool m_zoomEnabled = true;
+    double m_zoom = 1.0;                       // 1.0 shows the whole frame
+    QPointF m_zoomCenter = QPointF(0.5, 0.5);  // Center of the requested region
+    QRectF m_activeRoi = QRectF(0, 0, 1, 1);   // Region the received frames show (confirmed by the server)
+    QTimer m_roiTimer;                         // Debounces set_roi messages while a gesture is running
+    bool m_panning = false;
+    bool m_touchMoved = false;                 // A touch sequence panned or pinched, so it is not a tap
+    QPointF m_lastPanPos;
+    qreal m_pinchStartDistance = 0;
+    double m_pinchStartZoom = 1.0;
+    QPointF m_pinchAnchor;                     // Frame point under the pinch centroid when the pinch started
+    // Scaled frame cache: m_image scaled to the target rect, patched in place by tile updates
+    QImage m_scaledFrame;
+    qint64 m_scaledFrameKey = 0;               // m_image.cacheKey() the cache was built from
+    QRect m_scaledTarget;
+    QRectF m_scaledSource;
+    int m_scaledUndistortMode = 0;             // Client-side undistortion mode the cache was built with
+    // Tile-based delta frame members
+    bool m_tileUpdates = false;
+    qint64 m_lastKeyframeRequest = 0;
+    bool m_skippedTiles = false;               // Deltas were skipped by the CPU governor since the last keyframe
+    // CPU governor members
+    int m_priority = 0;                        // Higher priority widgets are degraded last
+    int m_governorLevel = 0;                   // CpuGovernor::Level currently applied
+    bool m_scaledFast = false;                 // Scaled frame cache was built with fast scaling
+    quint64 m_governorFrameCounter = 0;
+    quint64 m_governorSkippedFrames = 0;
+    // Duplicate frame detection: identity of the compressed payload currently on screen
+    size_t m_lastPayloadHash = 0;
+    qsizetype m_lastPayloadSize = -1;         // -1 when m_image does not correspond to a single payload
+    quint64 m_duplicateFrames = 0;
+    // Incremental decode of WebSocket messages that arrive in several fragments
+    IncrementalJpegDecoder m_incrementalDecoder; // Also the reused receive buffer
+    bool m_messageComplete = true;           // The next fragment starts a new message
+    bool m_incrementalMessage = false;       // The message being handled was decoded while it arrived
+    quint64 m_incrementalDecodes = 0;
+    double m_decodeNsecsAvg = 0;             // Smoothed decode time of these frames...
+    double m_decodeTailNsecsAvg = 0;         // ...and the part of it left after the last fragment
+    // Compressed JPEG of the frame on screen for snapshots; empty after tiles or raw shared memory frames
+    QByteArray m_lastPayload;
+    qint64 m_lastPayloadTimestamp = 0;       // Server timestamp of m_image
+    // Presentation coalescing: at most one paint per display refresh or per 1/maxFps
+    QTimer m_presentTimer;
+    QElapsedTimer m_lastPresent;
+    QRegion m_pendingPresent;
 };
 
 //--------------------------------------------------------------------------------
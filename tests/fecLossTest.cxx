@@ -0,0 +1,162 @@
+#include <udpFec.hxx>
+
+#include <QList>
+#include <QRandomGenerator>
+#include <cstdio>
+#include <functional>
+
+//--------------------------------------------------------------------------------
+// Loss-injection test for the UDP forward error correction. A stub sender encodes
+// frames like StreamServer does and drops datagrams before they reach the
+// reassembler, which must rebuild one lost fragment per group and count what it
+// cannot rebuild.
+
+namespace {
+const int kFragmentSize = 1000;
+const int kGroupSize = 4;
+
+int failures = 0;
+
+void check(bool condition, const char *what, int line)
+{
+    if (!condition) {
+        std::fprintf(stderr, "FAIL line %d: %s\n", line, what);
+        failures++;
+    }
+}
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+QByteArray makeFrame(qsizetype size)
+{
+    QByteArray frame(size, Qt::Uninitialized);
+    for (qsizetype i = 0; i < size; ++i)
+        frame[i] = char(QRandomGenerator::global()->bounded(256));
+    return frame;
+}
+
+// Stub sender: encodes a frame and delivers every datagram the drop predicate lets through,
+// optionally in reverse order. Returns the number of frames the receiver completed.
+int sendWithLoss(FecReassembler &receiver, const QByteArray &frame, quint32 frameId,
+                 const std::function<bool(int)> &drop, QByteArray *received = nullptr, bool reversed = false)
+{
+    QList<QByteArray> datagrams = FecReassembler::encode(frame, frameId, kFragmentSize, kGroupSize);
+    int completed = 0;
+    for (int n = 0; n < datagrams.size(); ++n) {
+        int i = reversed ? int(datagrams.size()) - 1 - n : n;
+        if (drop(i))
+            continue;
+        QByteArray out;
+        if (receiver.addDatagram(datagrams.at(i), out)) {
+            completed++;
+            if (received)
+                *received = out;
+        }
+    }
+    return completed;
+}
+
+// Datagram positions in sending order: each group of kGroupSize data fragments is followed by its parity
+int dataPosition(int fragment) { return fragment + fragment / kGroupSize; }
+int parityPosition(int group, int dataCount) { return qMin((group + 1) * kGroupSize, dataCount) + group; }
+
+void testOneLossPerGroupIsRecovered()
+{
+    // 10 fragments in groups of 4, 4 and 2; the last fragment is short
+    QByteArray frame = makeFrame(9 * kFragmentSize + 321);
+    FecReassembler receiver;
+    QList<int> dropped = { dataPosition(1), dataPosition(4), dataPosition(9) };
+    QByteArray received;
+    int completed = sendWithLoss(receiver, frame, 1, [&](int i) { return dropped.contains(i); }, &received);
+    CHECK(completed == 1);
+    CHECK(received == frame);
+    CHECK(receiver.stats().completeFrames == 1);
+    CHECK(receiver.stats().recoveredFragments == 3);
+    CHECK(receiver.stats().unrecoverableFrames == 0);
+}
+
+void testRecoveryWithParityFirst()
+{
+    QByteArray frame = makeFrame(8 * kFragmentSize);
+    FecReassembler receiver;
+    QByteArray received;
+    int completed = sendWithLoss(receiver, frame, 1, [](int i) { return i == dataPosition(0) || i == dataPosition(7); },
+                                 &received, true);
+    CHECK(completed == 1);
+    CHECK(received == frame);
+    CHECK(receiver.stats().recoveredFragments == 2);
+}
+
+void testLostParityNeedsNoRecovery()
+{
+    QByteArray frame = makeFrame(6 * kFragmentSize);
+    FecReassembler receiver;
+    QByteArray received;
+    int completed = sendWithLoss(receiver, frame, 1, [](int i) { return i == parityPosition(0, 6); }, &received);
+    CHECK(completed == 1);
+    CHECK(received == frame);
+    CHECK(receiver.stats().recoveredFragments == 0);
+}
+
+void testTwoLossesInAGroupAreUnrecoverable()
+{
+    FecReassembler receiver;
+    QByteArray lost = makeFrame(8 * kFragmentSize);
+    int completed = sendWithLoss(receiver, lost, 1, [](int i) { return i == dataPosition(2) || i == dataPosition(3); });
+    CHECK(completed == 0);
+    CHECK(receiver.stats().unrecoverableFrames == 0); // Still pending until a newer frame is delivered
+
+    QByteArray next = makeFrame(8 * kFragmentSize);
+    QByteArray received;
+    completed = sendWithLoss(receiver, next, 2, [](int) { return false; }, &received);
+    CHECK(completed == 1);
+    CHECK(received == next);
+    CHECK(receiver.stats().completeFrames == 1);
+    CHECK(receiver.stats().unrecoverableFrames == 1);
+
+    // Late fragments of the abandoned frame are ignored
+    completed = sendWithLoss(receiver, lost, 1, [](int) { return false; });
+    CHECK(completed == 0);
+    CHECK(receiver.stats().completeFrames == 1);
+}
+
+void testRandomLossOverManyFrames()
+{
+    // One loss in every group of every frame: all frames must come through
+    FecReassembler receiver;
+    const int frames = 50;
+    int completed = 0;
+    int dropped = 0;
+    for (quint32 id = 1; id <= quint32(frames); ++id) {
+        QByteArray frame = makeFrame(QRandomGenerator::global()->bounded(1, 20 * kFragmentSize));
+        int dataCount = int((frame.size() + kFragmentSize - 1) / kFragmentSize);
+        QList<int> drop;
+        for (int group = 0; group * kGroupSize < dataCount; ++group) {
+            int groupEnd = qMin((group + 1) * kGroupSize, dataCount);
+            int victim = QRandomGenerator::global()->bounded(group * kGroupSize, groupEnd + 1);
+            // victim == groupEnd stands for the group's parity
+            drop.append(victim == groupEnd ? parityPosition(group, dataCount) : dataPosition(victim));
+            if (victim != groupEnd)
+                dropped++;
+        }
+        QByteArray received;
+        completed += sendWithLoss(receiver, frame, id, [&](int i) { return drop.contains(i); }, &received);
+        CHECK(received == frame);
+    }
+    CHECK(completed == frames);
+    CHECK(receiver.stats().completeFrames == quint64(frames));
+    CHECK(receiver.stats().recoveredFragments == quint64(dropped));
+    CHECK(receiver.stats().unrecoverableFrames == 0);
+}
+}
+
+int main()
+{
+    testOneLossPerGroupIsRecovered();
+    testRecoveryWithParityFirst();
+    testLostParityNeedsNoRecovery();
+    testTwoLossesInAGroupAreUnrecoverable();
+    testRandomLossOverManyFrames();
+    if (failures == 0)
+        std::printf("fecLossTest: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+#include <udpFec.hxx>
+
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const quint16 kMagic = 0x5346; // 'SF'
+const quint8 kVersion = 1;
+const quint8 kFlagParity = 0x01;
+
+void xorInto(QByteArray &target, const QByteArray &source)
+{
+    char *dst = target.data();
+    const char *src = source.constData();
+    qsizetype n = qMin(target.size(), source.size());
+    for (qsizetype i = 0; i < n; ++i)
+        dst[i] ^= src[i];
+}
+
+QByteArray makeDatagram(quint8 flags, quint32 frameId, int index, int dataCount, int groupSize,
+                        quint32 frameSize, const char *payload, int length)
+{
+    QByteArray datagram(FecReassembler::kHeaderSize + length, Qt::Uninitialized);
+    uchar *ptr = reinterpret_cast<uchar *>(datagram.data());
+    qToBigEndian<quint16>(kMagic, ptr);
+    ptr[2] = kVersion;
+    ptr[3] = flags;
+    qToBigEndian<quint32>(frameId, ptr + 4);
+    qToBigEndian<quint16>(quint16(index), ptr + 8);
+    qToBigEndian<quint16>(quint16(dataCount), ptr + 10);
+    qToBigEndian<quint16>(quint16(groupSize), ptr + 12);
+    qToBigEndian<quint16>(quint16(length), ptr + 14);
+    qToBigEndian<quint32>(frameSize, ptr + 16);
+    memcpy(ptr + FecReassembler::kHeaderSize, payload, size_t(length));
+    return datagram;
+}
+}
+
+//--------------------------------------------------------------------------------
+
+/**
+ * \brief FecReassembler::isFecDatagram
+ * Tells FEC fragments apart from plain frame datagrams, which start with a timestamp.
+ * \param datagram The received datagram.
+ * \return True if the datagram carries the FEC fragment header.
+ */
+bool FecReassembler::isFecDatagram(const QByteArray &datagram)
+{
+    return datagram.size() >= kHeaderSize &&
+           qFromBigEndian<quint16>(datagram.constData()) == kMagic &&
+           quint8(datagram.at(2)) == kVersion;
+}
+
+/**
+ * \brief FecReassembler::encode
+ * Splits a frame message into data fragments plus one XOR parity fragment per group.
+ * \param frame The frame message (timestamp followed by image data).
+ * \param frameId Sequence number of the frame.
+ * \param fragmentSize Payload bytes per data fragment.
+ * \param groupSize Data fragments per parity fragment.
+ * \return The datagrams in sending order, each group followed by its parity.
+ */
+QList<QByteArray> FecReassembler::encode(const QByteArray &frame, quint32 frameId, int fragmentSize, int groupSize)
+{
+    QList<QByteArray> datagrams;
+    if (frame.isEmpty() || fragmentSize <= 0 || fragmentSize > 0xFFFF || groupSize <= 0)
+        return datagrams;
+    int dataCount = int((frame.size() + fragmentSize - 1) / fragmentSize);
+    if (dataCount > 0xFFFF)
+        return datagrams;
+
+    for (int first = 0; first < dataCount; first += groupSize) {
+        QByteArray parity(fragmentSize, '\0');
+        int last = qMin(first + groupSize, dataCount);
+        for (int i = first; i < last; ++i) {
+            qsizetype offset = qsizetype(i) * fragmentSize;
+            int length = int(qMin<qsizetype>(fragmentSize, frame.size() - offset));
+            QByteArray fragment = QByteArray::fromRawData(frame.constData() + offset, length);
+            xorInto(parity, fragment);
+            datagrams.append(makeDatagram(0, frameId, i, dataCount, groupSize, quint32(frame.size()),
+                                          fragment.constData(), length));
+        }
+        datagrams.append(makeDatagram(kFlagParity, frameId, first / groupSize, dataCount, groupSize,
+                                      quint32(frame.size()), parity.constData(), fragmentSize));
+    }
+    return datagrams;
+}
+
+/**
+ * \brief FecReassembler::addDatagram
+ * Stores a fragment, rebuilds a single missing fragment of its group from parity when possible
+ * and returns the frame message once all data fragments are present. Frames older than a
+ * delivered one are abandoned, only the newest frame matters for display.
+ * \param datagram The received FEC datagram.
+ * \param frame Receives the reassembled frame message.
+ * \return True if a frame was completed by this datagram.
+ */
+bool FecReassembler::addDatagram(const QByteArray &datagram, QByteArray &frame)
+{
+    if (!isFecDatagram(datagram))
+        return false;
+    const uchar *ptr = reinterpret_cast<const uchar *>(datagram.constData());
+    bool isParity = (ptr[3] & kFlagParity) != 0;
+    quint32 frameId = qFromBigEndian<quint32>(ptr + 4);
+    int index = qFromBigEndian<quint16>(ptr + 8);
+    int dataCount = qFromBigEndian<quint16>(ptr + 10);
+    int groupSize = qFromBigEndian<quint16>(ptr + 12);
+    int length = qFromBigEndian<quint16>(ptr + 14);
+    quint32 frameSize = qFromBigEndian<quint32>(ptr + 16);
+
+    if (dataCount == 0 || groupSize == 0 || length == 0 || datagram.size() != kHeaderSize + length)
+        return false;
+    int groupCount = (dataCount + groupSize - 1) / groupSize;
+    if (index >= (isParity ? groupCount : dataCount))
+        return false;
+    if (m_haveDelivered && !isNewer(frameId, m_lastDelivered))
+        return false; // Late fragment of a frame that is already shown or abandoned
+
+    auto it = m_pending.find(frameId);
+    if (it == m_pending.end()) {
+        PendingFrame pending;
+        pending.frameSize = frameSize;
+        pending.groupSize = groupSize;
+        pending.data.resize(dataCount);
+        pending.parity.resize(groupCount);
+        it = m_pending.insert(frameId, pending);
+        // Bound memory: give up on the oldest incomplete frames
+        while (m_pending.size() > kMaxPendingFrames) {
+            m_pending.erase(m_pending.begin());
+            m_stats.unrecoverableFrames++;
+        }
+        it = m_pending.find(frameId);
+        if (it == m_pending.end())
+            return false; // This frame was the oldest one
+    }
+    PendingFrame &pending = *it;
+    if (pending.data.size() != dataCount || pending.groupSize != groupSize || pending.frameSize != frameSize)
+        return false; // Inconsistent with the fragments seen so far
+
+    QByteArray payload = datagram.mid(kHeaderSize);
+    if (isParity) {
+        if (!pending.parity[index].isNull())
+            return false;
+        pending.fragmentSize = length; // Parity is always padded to the fragment size
+        pending.parity[index] = payload;
+        tryRecover(pending, index);
+    } else {
+        if (!pending.data[index].isNull())
+            return false;
+        if (index < dataCount - 1)
+            pending.fragmentSize = length; // All but the last fragment are full size
+        pending.data[index] = payload;
+        pending.received++;
+        tryRecover(pending, index / groupSize);
+    }
+
+    if (pending.received < dataCount)
+        return false;
+
+    QByteArray assembled;
+    assembled.reserve(pending.frameSize);
+    for (const QByteArray &fragment : pending.data)
+        assembled.append(fragment);
+    bool complete = assembled.size() == qsizetype(pending.frameSize);
+    dropOlderThan(frameId);
+    m_pending.remove(frameId);
+    m_lastDelivered = frameId;
+    m_haveDelivered = true;
+    if (!complete) {
+        m_stats.unrecoverableFrames++; // Fragment sizes did not add up
+        return false;
+    }
+    m_stats.completeFrames++;
+    frame = assembled;
+    return true;
+}
+
+/**
+ * \brief FecReassembler::reset
+ * Forgets all pending frames, e.g. when a new stream is requested.
+ */
+void FecReassembler::reset()
+{
+    m_pending.clear();
+    m_haveDelivered = false;
+}
+
+int FecReassembler::fragmentLength(const PendingFrame &pending, int index) const
+{
+    int dataCount = int(pending.data.size());
+    if (index < dataCount - 1)
+        return pending.fragmentSize;
+    return int(pending.frameSize - quint32(dataCount - 1) * quint32(pending.fragmentSize));
+}
+
+/**
+ * \brief FecReassembler::tryRecover
+ * Rebuilds the fragment of a group if exactly one is missing and the parity has arrived.
+ * \param pending The frame the group belongs to.
+ * \param group Index of the parity group.
+ */
+void FecReassembler::tryRecover(PendingFrame &pending, int group)
+{
+    if (pending.parity[group].isNull() || pending.fragmentSize <= 0)
+        return;
+    int first = group * pending.groupSize;
+    int last = qMin(first + pending.groupSize, int(pending.data.size()));
+    int missing = -1;
+    for (int i = first; i < last; ++i) {
+        if (pending.data[i].isNull()) {
+            if (missing >= 0)
+                return; // More than one fragment missing, XOR parity cannot help
+            missing = i;
+        }
+    }
+    if (missing < 0)
+        return;
+
+    int length = fragmentLength(pending, missing);
+    if (length <= 0 || length > pending.fragmentSize)
+        return;
+    QByteArray recovered = pending.parity[group];
+    for (int i = first; i < last; ++i) {
+        if (i != missing)
+            xorInto(recovered, pending.data[i]);
+    }
+    recovered.truncate(length);
+    pending.data[missing] = recovered;
+    pending.received++;
+    m_stats.recoveredFragments++;
+}
+
+/**
+ * \brief FecReassembler::dropOlderThan
+ * Abandons incomplete frames older than a delivered frame and counts them as unrecoverable.
+ * \param frameId The frame that was just delivered.
+ */
+void FecReassembler::dropOlderThan(quint32 frameId)
+{
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (isNewer(frameId, it.key())) {
+            it = m_pending.erase(it);
+            m_stats.unrecoverableFrames++;
+        } else {
+            ++it;
+        }
+    }
+}
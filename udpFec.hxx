@@ -0,0 +1,67 @@
+#ifndef _udpFec_H_
+#define _udpFec_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+
+//--------------------------------------------------------------------------------
+// Forward error correction for the UDP transports.
+// With FEC negotiated in set_stream, StreamServer splits every frame message into
+// fixed-size data fragments and adds one XOR parity fragment per group of
+// groupSize data fragments. One lost fragment per group is rebuilt from the
+// parity without a retransmission round trip.
+//
+// Datagram layout (big endian), followed by the fragment payload:
+//   quint16 magic 'SF' | quint8 version | quint8 flags (bit 0: parity)
+//   quint32 frame id   | quint16 index (fragment, or group for parity)
+//   quint16 data fragment count | quint16 group size | quint16 payload length
+//   quint32 frame size
+// Parity payloads are the XOR of the group's fragments zero-padded to the
+// fragment size, so their length is the fragment size.
+
+class FecReassembler
+{
+  public:
+    struct Stats {
+        quint64 completeFrames = 0;
+        quint64 recoveredFragments = 0;   // Rebuilt from parity
+        quint64 unrecoverableFrames = 0;  // Abandoned with fragments missing
+    };
+
+    static constexpr int kHeaderSize = 20;
+
+    static bool isFecDatagram(const QByteArray &datagram);
+    // Splits a frame message into data and parity datagrams, the sender side of the scheme.
+    // Stub senders use it to test recovery locally by dropping datagrams before sending.
+    static QList<QByteArray> encode(const QByteArray &frame, quint32 frameId, int fragmentSize, int groupSize);
+
+    // Adds a datagram; returns true and sets frame when a frame message is complete
+    bool addDatagram(const QByteArray &datagram, QByteArray &frame);
+    void reset();
+    const Stats &stats() const { return m_stats; }
+
+  private:
+    struct PendingFrame {
+        quint32 frameSize = 0;
+        int fragmentSize = 0;
+        int groupSize = 0;
+        int received = 0;
+        QList<QByteArray> data;
+        QList<QByteArray> parity;
+    };
+
+    static bool isNewer(quint32 a, quint32 b) { return qint32(a - b) > 0; }
+    int fragmentLength(const PendingFrame &pending, int index) const;
+    void tryRecover(PendingFrame &pending, int group);
+    void dropOlderThan(quint32 frameId);
+
+    static constexpr int kMaxPendingFrames = 4;
+
+    QMap<quint32, PendingFrame> m_pending;
+    quint32 m_lastDelivered = 0;
+    bool m_haveDelivered = false;
+    Stats m_stats;
+};
+
+#endif